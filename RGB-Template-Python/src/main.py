@@ -137,6 +137,77 @@ def curve_function(x, curve_scale):
             (1 - math.pow(2.718, -(curve_scale / 10)))) * x
 
 
+def round_half_away(x):
+    """Round to the nearest whole number, halves away from zero, like C's roundf."""
+    return math.floor(x + 0.5) if x >= 0 else -math.floor(-x + 0.5)
+
+
+# motion_profile.py
+
+# The time in sec between the samples of a motion profile, one control loop tick
+PROFILE_DT = 0.01
+
+
+def profile_shape(distance, max_velocity, acceleration, start_velocity=0.0, end_velocity=0.0):
+    """Compute the phases of a trapezoidal profile.
+
+    Distances are in inches for drives and degrees for turns, velocities and accelerations per second.
+    Returns (direction, start, peak and end velocity, acceleration, accel, cruise and decel time,
+    accel and cruise distance, total distance).
+    """
+    direction = -1.0 if distance < 0 else 1.0
+    total_distance = abs(distance)
+    a = max(abs(acceleration), 1.0)
+    max_velocity = max(abs(max_velocity), 1.0)
+    start_velocity = min(abs(start_velocity), max_velocity)
+    end_velocity = min(abs(end_velocity), max_velocity)
+
+    # The highest speed reachable when accelerating from the start speed and then decelerating
+    # to the end speed within the distance
+    reachable = math.sqrt(max((2 * a * total_distance + start_velocity * start_velocity
+                               + end_velocity * end_velocity) * 0.5, 0.0))
+    peak_velocity = min(max_velocity, reachable)
+    peak_velocity = max(peak_velocity, start_velocity, end_velocity)
+
+    accel_time = (peak_velocity - start_velocity) / a
+    decel_time = (peak_velocity - end_velocity) / a
+    accel_distance = (start_velocity + peak_velocity) * 0.5 * accel_time
+    decel_distance = (peak_velocity + end_velocity) * 0.5 * decel_time
+    cruise_distance = max(total_distance - accel_distance - decel_distance, 0.0)
+    cruise_time = cruise_distance / peak_velocity if peak_velocity > 0 else 0
+    return (direction, start_velocity, peak_velocity, end_velocity, a, accel_time, cruise_time, decel_time,
+            accel_distance, cruise_distance, total_distance)
+
+
+def profile_duration(shape):
+    """Return the time in sec a profile takes."""
+    return shape[5] + shape[6] + shape[7]
+
+
+def profile_at(shape, t):
+    """Return the (position, velocity) target of a profile at a time in sec from its start."""
+    (direction, start_velocity, peak_velocity, end_velocity, a, accel_time, cruise_time, decel_time,
+     accel_distance, cruise_distance, total_distance) = shape
+    if t < accel_time:
+        velocity = start_velocity + a * t
+        position = (start_velocity + velocity) * 0.5 * t
+    elif t < accel_time + cruise_time:
+        velocity = peak_velocity
+        position = accel_distance + peak_velocity * (t - accel_time)
+    elif t < accel_time + cruise_time + decel_time:
+        td = t - accel_time - cruise_time
+        velocity = peak_velocity - a * td
+        position = accel_distance + cruise_distance + (peak_velocity + velocity) * 0.5 * td
+    else:
+        velocity = end_velocity
+        position = total_distance
+    return direction * min(position, total_distance), direction * velocity
+
+
+# No acceleration limit or tip prevention: (max accel volts, max decel volts, tip angle, tip gain)
+NO_DRIVE_LIMITS = (24, 24, 0, 0)
+
+
 class Drive:
     """
     A class to control the robot's drivetrain.
@@ -175,6 +246,15 @@ class Drive:
         self.turn_settle_time = 200
         self.turn_timeout = 1500
         
+        # The turn gains scheduled by turn size, from the smallest turn to the largest. Each row is
+        # (max turn size, kp, ki, kd, starti, peak turn rate, angular acceleration). Turns use the
+        # single set of PID constants above when the schedule is empty.
+        self.turn_schedule = []
+        # Feedforward constants for following a turn profile
+        self.turn_ks = 0.0
+        self.turn_kv = 0.0
+        self.turn_ka = 0.0
+        
         # PID constants for driving
         self.drive_max_voltage = 0
         self.drive_kp = 0
@@ -187,13 +267,18 @@ class Drive:
         self.drive_settle_time = 200
         self.drive_timeout = 2000
         
+        # Feedforward constants for driving: volts to overcome static friction, volts per inch/sec
+        # and volts per inch/sec^2
+        self.drive_ks = 0.0
+        self.drive_kv = 0.0
+        self.drive_ka = 0.0
+        
         # PID constants for maintaining heading while driving
         self.heading_max_voltage = 0.0
         self.heading_kp = 0.0
         self.heading_kd = 0.0
         
         # Constants for arcade drive
-        self.k_brake = 0.5
         self.k_turn_bias = 0.5
         self.k_turn_damping_factor = 0.85
         
@@ -203,6 +288,24 @@ class Drive:
         
         # Default brake type
         self.stop_mode = BrakeType.COAST
+        # The acceleration limits and tip prevention of the driver control functions, set by the drive mode
+        self.drive_limits = NO_DRIVE_LIMITS
+        
+        # Active brake: when the joysticks are released, each side is slowed by a velocity loop until it
+        # comes to rest, then held there by a position loop, for active_brake_time msec. The gains are scaled
+        # by the speed at release over k_brake_full_speed, down to k_brake_min_scale.
+        # k_brake is in volts per inch and k_brake_damping in volts per inch/sec.
+        self.k_brake = 2.0
+        self.k_brake_damping = 0.4
+        self.k_brake_full_speed = 30.0
+        self.k_brake_min_scale = 0.3
+        self.active_brake_time = 500
+        # The state of the active brake
+        self.braking = False
+        self.brake_end_time = 0
+        self.brake_scale = 1.0
+        self.brake_targets = [0.0, 0.0]
+        self.brake_latched = [False, False]
         
         # Control flags
         self.drivetrain_needs_stopped = False
@@ -225,6 +328,22 @@ class Drive:
         self.drive_kd = drive_kd
         self.drive_starti = drive_starti
     
+    def set_drive_feedforward(self, drive_ks, drive_kv, drive_ka):
+        """Set feedforward constants for driving."""
+        self.drive_ks = drive_ks
+        self.drive_kv = drive_kv
+        self.drive_ka = drive_ka
+    
+    def set_turn_schedule(self, turn_schedule):
+        """Set the turn gains scheduled by turn size, sorted by max turn size."""
+        self.turn_schedule = turn_schedule
+    
+    def set_turn_feedforward(self, turn_ks, turn_kv, turn_ka):
+        """Set feedforward constants for following turn profiles."""
+        self.turn_ks = turn_ks
+        self.turn_kv = turn_kv
+        self.turn_ka = turn_ka
+    
     def set_heading_pid(self, heading_max_voltage, heading_kp, heading_kd):
         """Set PID constants for maintaining heading."""
         self.heading_max_voltage = heading_max_voltage
@@ -265,15 +384,23 @@ class Drive:
         self.left_drive.spin(FORWARD, left_voltage, VoltageUnits.VOLT)
         self.right_drive.spin(FORWARD, right_voltage, VoltageUnits.VOLT)
     
-    def turn_to_heading(self, heading, turn_max_voltage=None):
-        """Turn the robot to a specific heading."""
+    def turn_to_heading(self, heading, turn_max_voltage=None, early_exit_factor=1):
+        """Turn the robot to a specific heading.
+
+        early_exit_factor: nonstopping if greater than 1. Maximum is 5.
+        """
         if turn_max_voltage is None:
             turn_max_voltage = self.turn_max_voltage
+        early_exit_factor = threshold(early_exit_factor, 1, 5)
+        if self.turn_schedule:
+            self.turn_profiled(heading, turn_max_voltage, early_exit_factor)
+            return
         
         self.desired_heading = normalize_360(heading)
         turn_pid = PID(normalize_180(heading - self.get_heading()), 
                       self.turn_kp, self.turn_ki, self.turn_kd, self.turn_starti,
-                      self.turn_settle_error, self.turn_settle_time, self.turn_timeout)
+                      self.turn_settle_error * early_exit_factor,
+                      self.turn_settle_time / early_exit_factor, self.turn_timeout)
         
         while not turn_pid.is_done() and not self.drivetrain_needs_stopped:
             error = normalize_180(heading - self.get_heading())
@@ -282,11 +409,65 @@ class Drive:
             self.drive_with_voltage(output, -output)
             wait(10, TimeUnits.MSEC)
         
-        self.left_drive.stop(BrakeType.HOLD)
-        self.right_drive.stop(BrakeType.HOLD)
+        if early_exit_factor == 1:
+            self.left_drive.stop(BrakeType.HOLD)
+            self.right_drive.stop(BrakeType.HOLD)
+    
+    def turn_profiled(self, heading, turn_max_voltage, early_exit_factor):
+        """Turn the robot to a heading along a rotational profile, with the gains scheduled by turn size."""
+        self.desired_heading = normalize_360(heading)
+        turn_angle = normalize_180(heading - self.get_heading())
+        
+        # Small turns get stiffer gains and a short profile; large turns get a faster profile and more damping
+        gains = self.turn_schedule[-1]
+        for row in self.turn_schedule:
+            if abs(turn_angle) <= row[0]:
+                gains = row
+                break
+        # Never plan a turn rate the voltage limit cannot reach, or the robot falls behind and overshoots
+        max_velocity = gains[5]
+        if self.turn_kv > 0:
+            max_velocity = min(max_velocity, (turn_max_voltage - self.turn_ks) / self.turn_kv)
+        shape = profile_shape(turn_angle, max_velocity, gains[6])
+        duration = profile_duration(shape)
+        
+        # The PID corrects the tracking error, so the timeout starts after the profile has ended
+        turn_pid = PID(0, gains[1], gains[2], gains[3], gains[4],
+                       self.turn_settle_error * early_exit_factor,
+                       self.turn_settle_time / early_exit_factor, self.turn_timeout + duration * 1000)
+        progress = 0.0
+        previous_velocity = 0.0
+        time = 0.0
+        # Follow the whole profile, then hold its end until the PID settles
+        while (time < duration or not turn_pid.is_done()) and not self.drivetrain_needs_stopped:
+            time += PROFILE_DT
+            target_position, target_velocity = profile_at(shape, min(time, duration))
+            # Unwrap the angle turned so far, so a 180 degree turn does not jump a full turn at the wrap
+            turned = turn_angle - normalize_180(heading - self.get_heading())
+            progress = turned + 360.0 * round_half_away((progress - turned) / 360.0)
+            error = target_position - progress
+            
+            acceleration = (target_velocity - previous_velocity) / PROFILE_DT
+            previous_velocity = target_velocity
+            output = turn_pid.compute(error) + self.turn_kv * target_velocity + self.turn_ka * acceleration
+            # Static friction is only overcome while the robot should be moving, so it does not dither once settled
+            if target_velocity != 0 or abs(error) > self.turn_settle_error:
+                output += self.turn_ks if output > 0 else -self.turn_ks
+            output = threshold(output, -turn_max_voltage, turn_max_voltage)
+            self.drive_with_voltage(output, -output)
+            wait(10, TimeUnits.MSEC)
+        
+        if early_exit_factor == 1:
+            self.left_drive.stop(BrakeType.HOLD)
+            self.right_drive.stop(BrakeType.HOLD)
     
-    def drive_distance(self, distance, drive_max_voltage=None, heading=None, heading_max_voltage=None):
-        """Drive the robot a specific distance."""
+    def drive_distance(self, distance, drive_max_voltage=None, heading=None, heading_max_voltage=None,
+                       early_exit_factor=1):
+        """Drive the robot a specific distance.
+
+        early_exit_factor: nonstopping if greater than 1. Maximum is 5.
+        """
+        early_exit_factor = threshold(early_exit_factor, 1, 5)
         if drive_max_voltage is None:
             drive_max_voltage = self.drive_max_voltage
         if heading is None:
@@ -295,7 +476,9 @@ class Drive:
             heading_max_voltage = self.heading_max_voltage
         
         self.desired_heading = normalize_360(heading)
-        drive_pid = PID(distance, self.drive_kp, self.drive_ki, self.drive_kd, self.drive_starti, self.drive_settle_error, self.drive_settle_time, self.drive_timeout)
+        drive_pid = PID(distance, self.drive_kp, self.drive_ki, self.drive_kd, self.drive_starti,
+                        self.drive_settle_error * early_exit_factor,
+                        self.drive_settle_time / early_exit_factor, self.drive_timeout)
         
         heading_pid = PID(normalize_180(self.desired_heading - self.get_heading()),
                          self.heading_kp, 0.0, self.heading_kd, 0.0, 0.0, 0.0, 0.0)
@@ -316,8 +499,9 @@ class Drive:
             self.drive_with_voltage(drive_output + heading_output, drive_output - heading_output)
             wait(10, TimeUnits.MSEC)
         
-        self.left_drive.stop(BrakeType.HOLD)
-        self.right_drive.stop(BrakeType.HOLD)
+        if early_exit_factor == 1:
+            self.left_drive.stop(BrakeType.HOLD)
+            self.right_drive.stop(BrakeType.HOLD)
     
     def set_arcade_constants(self, k_brake, k_turn_bias, k_turn_damping_factor):
         """Set constants for arcade drive."""
@@ -325,12 +509,94 @@ class Drive:
         self.k_turn_bias = k_turn_bias
         self.k_turn_damping_factor = k_turn_damping_factor
     
+    def set_active_brake(self, k_brake_damping, k_brake_full_speed, active_brake_time):
+        """Set the active brake damping, the release speed that gets the full brake, and how long it holds."""
+        self.k_brake_damping = k_brake_damping
+        self.k_brake_full_speed = k_brake_full_speed
+        self.active_brake_time = active_brake_time
+    
+    def set_drive_limits(self, drive_limits):
+        """Set the acceleration limits and tip prevention of the driver control functions."""
+        self.drive_limits = drive_limits
+    
+    def get_wheel_velocity(self, wheel):
+        """Return the velocity of a motor or side in inch/sec."""
+        return wheel.velocity(VelocityUnits.DPS) * self.drive_in_to_deg_ratio
+    
+    def get_tip_correction(self):
+        """Return the acceleration voltage that lowers the robot when the pitch is past the tip angle, or 0."""
+        tip_angle, tip_gain = self.drive_limits[2], self.drive_limits[3]
+        if tip_angle <= 0:
+            return 0.0
+        pitch = self.gyro.pitch()
+        if abs(pitch) <= tip_angle:
+            return 0.0
+        # Front up: accelerate backwards to bring the wheels back under the robot. Front down: forwards
+        return -tip_gain * (pitch - (tip_angle if pitch > 0 else -tip_angle))
+    
+    def get_turn_scale(self):
+        """Return the share of the turn to keep when the roll is past the tip angle."""
+        tip_angle = self.drive_limits[2]
+        if tip_angle <= 0:
+            return 1.0
+        # Turning at speed rolls the robot outwards, so give up the turn until it is back under the tip angle
+        return threshold(2 - abs(self.gyro.roll()) / tip_angle, 0, 1)
+    
+    def limit_acceleration(self, voltage, velocity, tip_correction):
+        """Return the voltage for a wheel moving at a velocity in inch/sec, limited to the drive mode's acceleration."""
+        # The voltage that holds the current speed. Only the difference from it accelerates the wheel
+        hold_voltage = self.drive_kv * velocity
+        accel_voltage = voltage - hold_voltage
+        speeding_up = accel_voltage * velocity >= 0
+        limit = self.drive_limits[0] if speeding_up else self.drive_limits[1]
+        accel_voltage = threshold(accel_voltage, -limit, limit)
+        if tip_correction < 0:
+            accel_voltage = min(accel_voltage, tip_correction)
+        if tip_correction > 0:
+            accel_voltage = max(accel_voltage, tip_correction)
+        return threshold(hold_voltage + accel_voltage, -12, 12)
+    
+    def start_active_brake(self):
+        """Start the active brake with gains scaled by the speed at release."""
+        release_speed = max(abs(self.get_wheel_velocity(self.left_drive)), abs(self.get_wheel_velocity(self.right_drive)))
+        self.brake_scale = threshold(release_speed / self.k_brake_full_speed, self.k_brake_min_scale, 1)
+        self.brake_latched = [False, False]
+        self.brake_end_time = brain.timer.system() + self.active_brake_time
+        self.braking = True
+    
+    def brake_output(self, side, position, velocity):
+        """Return the voltage that brakes one side: damping until the side comes to rest, then a hold there."""
+        # Until the side slows below 2 inch/sec, the target follows it, so only the damping acts and the
+        # robot is not pulled back to where the joysticks were released
+        if not self.brake_latched[side]:
+            self.brake_targets[side] = position
+            if abs(velocity) < 2:
+                self.brake_latched[side] = True
+        return threshold(self.brake_scale * (self.k_brake * (self.brake_targets[side] - position)
+                                             - self.k_brake_damping * velocity), -12, 12)
+    
+    def update_active_brake(self):
+        """Run one tick of the active brake. Returns immediately, so it never holds up the driver loop."""
+        if brain.timer.system() >= self.brake_end_time:
+            self.left_drive.stop(self.stop_mode)
+            self.right_drive.stop(self.stop_mode)
+            self.braking = False
+            return
+        left_velocity = self.get_wheel_velocity(self.left_drive)
+        right_velocity = self.get_wheel_velocity(self.right_drive)
+        left_output = self.brake_output(0, self.get_left_position_in(), left_velocity)
+        right_output = self.brake_output(1, self.get_right_position_in(), right_velocity)
+        # Braking is a deceleration like any other, so it stays within the drive limits and the tip correction
+        tip_correction = self.get_tip_correction()
+        self.left_drive.spin(FORWARD, self.limit_acceleration(left_output, left_velocity, tip_correction), VoltageUnits.VOLT)
+        self.right_drive.spin(FORWARD, self.limit_acceleration(right_output, right_velocity, tip_correction), VoltageUnits.VOLT)
+    
     def control_arcade(self, y, x):
         """Control the robot in arcade mode."""
         throttle = deadband(y, 5)
         turn = deadband(x, 5) * self.k_turn_damping_factor
         
-        turn = curve_function(turn, self.k_turn)
+        turn = curve_function(turn, self.k_turn) * self.get_turn_scale()
         throttle = curve_function(throttle, self.k_throttle)
         
         left_power = to_volt(throttle + turn)
@@ -338,33 +604,34 @@ class Drive:
         
         if self.k_turn_bias > 0:
             if abs(throttle) + abs(turn) > 100:
-                old_throttle = throttle
-                old_turn = turn
+                # Whole percent, as in the C++ template
+                old_throttle = int(throttle)
+                old_turn = int(turn)
                 throttle *= (1 - self.k_turn_bias * abs(old_turn / 100.0))
                 turn *= (1 - (1 - self.k_turn_bias) * abs(old_throttle / 100.0))
             left_power = to_volt(throttle + turn)
             right_power = to_volt(throttle - turn)
         
         if abs(throttle) > 0 or abs(turn) > 0:
-            self.left_drive.spin(FORWARD, left_power, VoltageUnits.VOLT)
-            self.right_drive.spin(FORWARD, right_power, VoltageUnits.VOLT)
+            tip_correction = self.get_tip_correction()
+            self.left_drive.spin(FORWARD, self.limit_acceleration(left_power, self.get_wheel_velocity(self.left_drive), tip_correction),
+                                 VoltageUnits.VOLT)
+            self.right_drive.spin(FORWARD, self.limit_acceleration(right_power, self.get_wheel_velocity(self.right_drive), tip_correction),
+                                  VoltageUnits.VOLT)
             self.drivetrain_needs_stopped = True
+            self.braking = False
         else:
+            # When the joysticks are released, run the active brake.
+            # Adjust set_arcade_constants and set_active_brake to the amount of coasting preferred
             if self.drivetrain_needs_stopped:
                 if self.stop_mode != BrakeType.HOLD:
-                    self.left_drive.reset_position()
-                    self.right_drive.reset_position()
-                    wait(20, TimeUnits.MSEC)
-                    self.left_drive.spin(FORWARD, 
-                                       -self.left_drive.position(RotationUnits.REV) * self.k_brake, 
-                                       VoltageUnits.VOLT)
-                    self.right_drive.spin(FORWARD, 
-                                        -self.right_drive.position(RotationUnits.REV) * self.k_brake, 
-                                        VoltageUnits.VOLT)
+                    self.start_active_brake()
                 else:
                     self.left_drive.stop(BrakeType.HOLD)
                     self.right_drive.stop(BrakeType.HOLD)
                 self.drivetrain_needs_stopped = False
+            if self.braking:
+                self.update_active_brake()
     
     def control_tank(self, left, right):
         """Control the robot in tank mode."""
@@ -372,8 +639,14 @@ class Drive:
         right_throttle = curve_function(right, self.k_throttle)
         
         if abs(left_throttle) > 0 or abs(right_throttle) > 0:
-            self.left_drive.spin(FORWARD, to_volt(left_throttle), VoltageUnits.VOLT)
-            self.right_drive.spin(FORWARD, to_volt(right_throttle), VoltageUnits.VOLT)
+            # Scale the difference between the sides, which is the turn, when the robot rolls
+            forward = (left_throttle + right_throttle) * 0.5
+            turn = (left_throttle - right_throttle) * 0.5 * self.get_turn_scale()
+            tip_correction = self.get_tip_correction()
+            self.left_drive.spin(FORWARD, self.limit_acceleration(to_volt(forward + turn), self.get_wheel_velocity(self.left_drive), tip_correction),
+                                 VoltageUnits.VOLT)
+            self.right_drive.spin(FORWARD, self.limit_acceleration(to_volt(forward - turn), self.get_wheel_velocity(self.right_drive), tip_correction),
+                                  VoltageUnits.VOLT)
             self.drivetrain_needs_stopped = True
         else:
             if self.drivetrain_needs_stopped:
@@ -388,27 +661,36 @@ class Drive:
         straight = deadband(acc, 5)
         turn = deadband(steer, 5)
         straight = curve_function(straight, self.k_throttle)
-        turn = curve_function(turn, self.k_turn)
+        turn = curve_function(turn, self.k_turn) * self.get_turn_scale()
         
         if turn == 0 and strafe == 0 and throttle == 0 and straight == 0:
             if self.drivetrain_needs_stopped:
-                self.left_drive.stop(self.stop_mode)
-                self.right_drive.stop(self.stop_mode)
+                drive_lf.stop(self.stop_mode)
+                drive_rf.stop(self.stop_mode)
+                drive_lb.stop(self.stop_mode)
+                drive_rb.stop(self.stop_mode)
                 self.drivetrain_needs_stopped = False
-                return
+            return
         
-        if turn == 0 and straight == 0:
-            drive_lf.spin(FORWARD, to_volt(throttle + turn + strafe), VoltageUnits.VOLT)
-            drive_rf.spin(FORWARD, to_volt(throttle - turn - strafe), VoltageUnits.VOLT)
-            drive_lb.spin(FORWARD, to_volt(throttle + turn - strafe), VoltageUnits.VOLT)
-            drive_rb.spin(FORWARD, to_volt(throttle - turn + strafe), VoltageUnits.VOLT)
-        else:
-            # Arcade drive
-            left_power = to_volt(throttle + turn)
-            right_power = to_volt(throttle - turn)
-            self.left_drive.spin(FORWARD, left_power, VoltageUnits.VOLT)
-            self.right_drive.spin(FORWARD, right_power, VoltageUnits.VOLT)
-            self.drivetrain_needs_stopped = True
+        # Either forward axis drives forward. Scale all wheels down together if any is over 100%
+        forward = throttle + straight
+        power_lf = forward + turn + strafe
+        power_rf = forward - turn - strafe
+        power_lb = forward + turn - strafe
+        power_rb = forward - turn + strafe
+        max_power = max(abs(power_lf), abs(power_rf), abs(power_lb), abs(power_rb))
+        if max_power > 100:
+            scale = 100 / max_power
+            power_lf *= scale
+            power_rf *= scale
+            power_lb *= scale
+            power_rb *= scale
+        tip_correction = self.get_tip_correction()
+        drive_lf.spin(FORWARD, self.limit_acceleration(to_volt(power_lf), self.get_wheel_velocity(drive_lf), tip_correction), VoltageUnits.VOLT)
+        drive_rf.spin(FORWARD, self.limit_acceleration(to_volt(power_rf), self.get_wheel_velocity(drive_rf), tip_correction), VoltageUnits.VOLT)
+        drive_lb.spin(FORWARD, self.limit_acceleration(to_volt(power_lb), self.get_wheel_velocity(drive_lb), tip_correction), VoltageUnits.VOLT)
+        drive_rb.spin(FORWARD, self.limit_acceleration(to_volt(power_rb), self.get_wheel_velocity(drive_rb), tip_correction), VoltageUnits.VOLT)
+        self.drivetrain_needs_stopped = True
     
     def stop(self, mode):
         """Stop the drivetrain with specified brake mode."""
@@ -454,6 +736,13 @@ NUMBER_OF_MOTORS = 6   # Total number of motors, including drivetrain
 WHEEL_DIAMETER = 2.75  # in inches
 GEAR_RATIO = 0.75      # output (wheel) speed / input (motor) speed
 
+# The acceleration limits and tip prevention of each drive mode: volts above the speed-holding voltage
+# when speeding up, volts below it when slowing down or reversing, the pitch/roll in degrees where tip
+# prevention starts, and volts per degree past it. Indexed by DRIVE_MODE.
+ARCADE_LIMITS = (8, 6, 10, 0.5)
+MECANUM_LIMITS = (6, 5, 10, 0.5)
+drive_mode_limits = [ARCADE_LIMITS, ARCADE_LIMITS, ARCADE_LIMITS, MECANUM_LIMITS]
+
 # Create motor groups
 left_drive = MotorGroup(left_motor1, left_motor2, left_motor3)
 right_drive = MotorGroup(right_motor1, right_motor2, right_motor3)
@@ -525,6 +814,15 @@ this is where custom code ends
 auton_num = 0
 exit_auton_menu = False
 
+# The turn gains scheduled by turn size, from the smallest turn to the largest.
+# Each row is: max turn size in deg, kp, ki, kd, starti, peak turn rate in deg/sec, angular acceleration in deg/sec^2.
+turn_schedule = [
+    (10, 0.4, 0, 2, 0, 200, 2000),
+    (45, 0.3, 0, 2, 0, 400, 2000),
+    (90, 0.25, 0, 2.5, 0, 500, 2000),
+    (180, 0.22, 0, 3, 0, 550, 1800),
+]
+
 def set_chassis_defaults():
     """Reset the chassis constants."""
     # Set the heading of the chassis to the current heading of the inertial sensor
@@ -536,6 +834,18 @@ def set_chassis_defaults():
     # Set the turn PID constants for the chassis
     chassis.set_turn_pid(10, 0.2, .015, 1.5, 7.5)
     
+    # Schedule the turn gains by turn size and follow a rotational profile on each turn.
+    # Remove this line to turn with the single set of PID constants above.
+    chassis.set_turn_schedule(turn_schedule)
+    
+    # Set the feedforward constants for following turn profiles.
+    # kV is 12 volts over the top turn rate, about 620 deg/sec; measure kS as the voltage where the robot starts to turn.
+    chassis.set_turn_feedforward(1.0, 0.0194, 0.0023)
+    
+    # Set the feedforward constants for driving.
+    # kV is 12 volts over the free speed of the wheels, about 65 inch/sec for 600 rpm motors, 0.75 gear ratio and 2.75" wheels.
+    chassis.set_drive_feedforward(0, 0.185, 0)
+    
     # Set the heading PID constants for the chassis
     chassis.set_heading_pid(6, 0.4, 1)
     
@@ -543,10 +853,14 @@ def set_chassis_defaults():
     chassis.set_drive_exit_conditions(1, 200, 2000)
     
     # Set the exit conditions for the turn functions
-    chassis.set_turn_exit_conditions(1.5, 200, 5500)
+    chassis.set_turn_exit_conditions(1.5, 200, 1500)
     
     # Set the arcade drive constants for the chassis
-    chassis.set_arcade_constants(0.5, 0.5, 0.85)
+    chassis.set_arcade_constants(2, 0.5, 0.85)
+    
+    # Set the active brake: volts per inch/sec of damping, the release speed in inch/sec that gets the
+    # full brake, and how long in msec the brake holds before the drivetrain coasts
+    chassis.set_active_brake(0.4, 30, 500)
 
 
 def check_motors(motor_count, temperature_limit=50):
@@ -659,6 +973,8 @@ def pre_auton():
     
     # Set the parameters for the chassis
     set_chassis_defaults()
+    if 0 <= DRIVE_MODE < len(drive_mode_limits):
+        chassis.set_drive_limits(drive_mode_limits[DRIVE_MODE])
     
     # Show the autonomous menu
     if gyro_setup_success and motors_setup_success:
@@ -687,9 +1003,10 @@ def usercontrol():
         elif DRIVE_MODE == 3:  # Mecanum drive
             chassis.control_mecanum(controller_1.axis4.position(), controller_1.axis3.position(),
                                   controller_1.axis2.position(), controller_1.axis1.position(),
-                                  left_motor1, left_motor2, right_motor1, right_motor2)
+                                  left_motor1, right_motor1, left_motor2, right_motor2)
         
-        wait(20, TimeUnits.MSEC)
+        # Runs at the same 10 ms period as the C++ driver control loop
+        wait(10, TimeUnits.MSEC)
 
 
 def main():
@@ -1,12 +1,18 @@
 #pragma once
 #include "rgb-template/drive.h"
-extern bool teamIsRed;
+#include "rgb-template/system-id.h"
 
 void pre_auton();
 void autonomous();
 void exitAuton();
 
 bool continueAutonStep();
+// Writes the name of the selected autonomous routine for the dashboard.
+void formatAutonSelection(char* text, int size);
 void registerAutonTestButtons();
-
-extern int currentAutonSelection;
\ No newline at end of file
+// Replays the motion log of the last match through the motion functions and shows where the commands diverge.
+void replayMotionLog();
+// Runs every step of the auton at a menu index for the benchmark, then restores the selection.
+void runBenchmarkAuton(int selection);
+// The plant the simulation tools run on. It is fixed, so their results only change when the motion code does.
+extern const DriveModel benchmarkModel;
\ No newline at end of file
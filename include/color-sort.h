@@ -0,0 +1,86 @@
+#pragma once
+#include "vex.h"
+
+// The color of a game object seen by the sorting sensor.
+enum objectColor { OBJECT_NONE, OBJECT_RED, OBJECT_BLUE };
+
+// A class to sort game objects by color as they travel through the rollers.
+// A background task samples the optical sensor as fast as it updates, and every
+// opponent object gets an eject scheduled at the roller position where it reaches the eject point.
+class ColorSort
+{
+private:
+  // The optical sensor that sees game objects entering the rollers.
+  optical& sensor;
+  // The roller motor used to measure how far an object has traveled since it was seen.
+  motor& roller;
+  // Called with true to start ejecting and with false to resume normal roller operation.
+  void (*ejectAction)(bool eject);
+
+  // Hue ranges for the red and blue game objects. Red wraps around 0.
+  float redHueMax = 30;
+  float redHueMin = 330;
+  float blueHueMin = 180;
+  float blueHueMax = 260;
+
+  // The roller travel in degrees between the sensor and the eject point.
+  float ejectTravelDeg = 360;
+  // The time in msec between commanding the eject and the rollers actually reversing.
+  float ejectLatency = 20;
+  // The time in msec the eject runs for.
+  float ejectTime = 150;
+
+  // The maximum number of opponent objects that can be in the rollers at once.
+  static const int MAX_PENDING_EJECTS = 4;
+  // The roller positions at which pending ejects must fire, oldest first.
+  float pendingEjects[MAX_PENDING_EJECTS];
+  int pendingEjectCount = 0;
+
+  // Whether sorting is enabled.
+  bool enabled = true;
+  // Whether the sensor currently sees an object, so that one object is only counted once.
+  bool objectPresent = false;
+  // Whether the eject is running and the time it ends.
+  bool ejecting = false;
+  float ejectEndTime = 0;
+
+  // Counters for measuring sorting throughput.
+  int objectsSeen = 0;
+  int objectsEjected = 0;
+  int objectsMissed = 0;
+  float firstObjectTime = 0;
+  float lastObjectTime = 0;
+
+  // The background task that samples the sensor and runs the ejects.
+  static int sortTask(void* colorSort);
+
+public:
+  // The constructor for the ColorSort class.
+  ColorSort(optical& sensor, motor& roller, void (*ejectAction)(bool eject));
+
+  // Starts the background sorting task.
+  void start();
+  // Runs one sample of the sorting pipeline. The background task runs it every 5 msec; a host test can
+  // run it on a manual clock instead.
+  void update();
+  // Enables or disables sorting. Pending ejects are dropped when disabled.
+  void setEnabled(bool enabled);
+  bool isEnabled();
+  // Returns true while an opponent object is being ejected.
+  bool isEjecting();
+
+  // Sets the hue ranges for red and blue game objects.
+  void setHueRanges(float redHueMin, float redHueMax, float blueHueMin, float blueHueMax);
+  // Sets the roller travel to the eject point, the actuation latency to compensate for and the eject time.
+  void setEjectTiming(float ejectTravelDeg, float ejectLatency, float ejectTime);
+
+  // Classifies the object currently in front of the sensor.
+  objectColor classify();
+
+  // Returns the number of objects sorted per second since the first object was seen.
+  float getThroughput();
+  // Resets the throughput counters.
+  void resetStats();
+  // Prints the sorting counters to the controller screen.
+  void printStats();
+};
@@ -0,0 +1,97 @@
+#pragma once
+#include "vex.h"
+#include <atomic>
+
+// The states of the intake rollers.
+enum intakeState {
+  INTAKE_STOP,        // rollers braked
+  INTAKE_COLLECT,     // bottom roller pulls game objects into storage
+  INTAKE_SCORE_LONG,  // both rollers run to score on the long goal
+  INTAKE_OUTTAKE,     // bottom roller pushes game objects out of the intake
+  INTAKE_HOLD,        // rollers hold their position
+  INTAKE_MANUAL,      // rollers run at the voltages given to setVoltage()
+  INTAKE_UNJAM        // rollers reverse briefly to clear a jam, then retry
+};
+
+// A class to run the intake rollers as a state machine with jam detection and recovery.
+// Commands only change the requested state and return immediately; a background task
+// stages the roller commands every tick, so buttons and autons can both command the intake without blocking.
+class Intake
+{
+private:
+  // The registry that sends the roller commands to the motors.
+  ActuatorRegistry& actuators;
+  // The registry id of the roller at the intake.
+  int bottomRoller;
+  // The registry id of the roller at the scoring end.
+  int topRoller;
+
+  // The fields below written by the commands are atomic, since buttons, macros, autons and the color
+  // sort command the intake from their own threads while the intake task runs the state machine.
+  // The state requested by the driver or auton.
+  std::atomic<intakeState> requestedState;
+  // The state the rollers are running in.
+  std::atomic<intakeState> state;
+  // The voltages for the manual state.
+  std::atomic<float> manualBottomVoltage;
+  std::atomic<float> manualTopVoltage;
+  // Whether the color sort is ejecting an object.
+  std::atomic<bool> ejecting;
+
+  // A roller is jammed when it draws more than jamCurrent amps while turning slower than
+  // jamVelocity rpm for jamTime msec.
+  float jamVelocity = 20;
+  float jamCurrent = 2;
+  float jamTime = 250;
+  // The time in msec the rollers reverse for when a jam is detected.
+  float unjamTime = 200;
+  // The number of unjam attempts before the intake gives up and stops.
+  int maxRetries = 3;
+  // The time in msec the rollers must run without a jam to reset the retry count.
+  float jamClearTime = 1000;
+
+  // Jam detection state.
+  float stallStartTime = -1;
+  float unjamEndTime = 0;
+  float lastJamTime = 0;
+  std::atomic<int> retries;
+  std::atomic<int> jamCount;
+
+  // The background task that runs the state machine.
+  static int intakeTask(void* intake);
+  // Runs one step of the state machine.
+  void update();
+  // Stages the roller commands for the current state.
+  void applyOutput();
+  // Returns true if the roller is stalled against a load while commanded to spin.
+  bool isStalled(int roller, float commandedVoltage);
+  // Returns the voltages commanded to each roller in a state.
+  float bottomVoltage(intakeState state);
+  float topVoltage(intakeState state);
+
+public:
+  // The constructor for the Intake class, taking the registry ids of the roller motors.
+  Intake(ActuatorRegistry& actuators, int bottomRoller, int topRoller);
+
+  // Starts the background task.
+  void start();
+
+  // Requests a new state. Returns immediately.
+  void set(intakeState state);
+  // Runs the rollers at specific voltages. Returns immediately.
+  void setVoltage(float bottomVoltage, float topVoltage);
+  // Overrides the rollers to throw out an opponent game object while true.
+  void setEjecting(bool ejecting);
+
+  // Returns the state requested by the driver or auton.
+  intakeState getRequestedState();
+  // Returns the state the rollers are running in.
+  intakeState getState();
+
+  // Sets the stall signature that counts as a jam.
+  void setJamDetection(float jamVelocity, float jamCurrent, float jamTime);
+  // Sets how long the rollers reverse to clear a jam and how many times to retry.
+  void setJamRecovery(float unjamTime, int maxRetries);
+  // Returns the number of jams detected since the program started.
+  int getJamCount();
+};
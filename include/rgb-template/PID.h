@@ -38,6 +38,9 @@ public:
   PID(float error, float kp, float kd);
   // A constructor for a full PID controller with P, I, and D terms, as well as exit conditions.
   PID(float error, float kp, float ki, float kd, float starti, float settleError, float settleTime, float timeout);
+  // Seeds the error of the previous iteration, so a PID taking over a running motion does not
+  // kick its derivative term on the first step.
+  void setPreviousError(float previousError);
   // Computes the PID output.
   float compute(float error);
   // Returns true if the PID has settled or timed out.
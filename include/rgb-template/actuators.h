@@ -0,0 +1,85 @@
+#pragma once
+#include "vex.h"
+
+// A motor of a subsystem registered with the ActuatorRegistry.
+struct Actuator
+{
+  // The name shown in health warnings and telemetry.
+  const char* name;
+  // The motor.
+  motor* device;
+  // The largest voltage the motor may be commanded with.
+  float maxVoltage;
+  // The brake mode used by stop() when no mode is given.
+  vex::brakeType defaultBrake;
+  // False for motors that are only health checked, such as the drivetrain, which drives its motors itself.
+  bool commanded;
+
+  // The command staged since the last flush.
+  bool stagedStop;
+  float stagedVoltage;
+  vex::brakeType stagedBrake;
+
+  // The command last sent to the motor.
+  bool appliedValid;
+  bool appliedStop;
+  float appliedVoltage;
+  vex::brakeType appliedBrake;
+};
+
+// A class to own the motors of the robot's subsystems.
+// Commands from any thread are staged and sent to the motors once per tick by a
+// background task, and only if they differ from what the motor is already doing.
+class ActuatorRegistry
+{
+private:
+  // The maximum number of motors that can be registered.
+  static const int MAX_ACTUATORS = 16;
+  // The registered motors.
+  Actuator actuators[MAX_ACTUATORS];
+  // The number of registered motors.
+  int actuatorCount = 0;
+  // Protects the staged commands.
+  vex::mutex stageLock;
+
+  // The flush period in msec.
+  int flushPeriod = 10;
+  // The number of commands sent to the motors, and the number skipped because nothing changed.
+  int commandsSent = 0;
+  int commandsSkipped = 0;
+
+  // The background task that flushes the staged commands.
+  static int flushTask(void* registry);
+
+public:
+  // Registers a motor. Returns the id used to command it, or -1 if the registry is full.
+  int add(const char* name, motor& device, float maxVoltage = 12, vex::brakeType defaultBrake = brake);
+  // Registers a motor that is health checked but never commanded by the registry. Returns its id, or -1 if the registry is full.
+  int monitor(const char* name, motor& device);
+
+  // Stages a voltage for a motor. The voltage is clamped to the motor's limit.
+  void spin(int id, float voltage);
+  // Stages a stop with the motor's default brake mode.
+  void stop(int id);
+  // Stages a stop with a specific brake mode.
+  void stop(int id, vex::brakeType mode);
+
+  // Sends the staged commands that changed since the last flush to the motors.
+  void flush();
+  // Starts the background task that flushes every period msec.
+  void start(int period = 10);
+
+  // Returns the number of registered motors.
+  int getCount();
+  // Returns the name of a registered motor.
+  const char* getName(int id);
+  // Returns a registered motor.
+  motor& getMotor(int id);
+  // Returns the number of commands sent to the motors.
+  int getCommandsSent();
+  // Returns the number of staged commands skipped because the motor was already doing them.
+  int getCommandsSkipped();
+
+  // Checks that all registered motors are connected and not overheating, and warns the driver if not.
+  bool checkHealth(int temperatureLimit = 50);
+};
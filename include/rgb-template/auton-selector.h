@@ -0,0 +1,72 @@
+#pragma once
+#include "vex.h"
+
+// The auton selection as stored on the SD card.
+struct SelectionRecord
+{
+  // Identifies a record written by the AutonSelector.
+  uint32_t magic;
+  // Incremented on every save, so the newest of the two slots can be found.
+  uint32_t sequence;
+  int32_t autonSelection;
+  int32_t driveMode;
+  // A checksum of the fields above. A record with a wrong checksum was not completely written.
+  uint32_t checksum;
+};
+
+// A class to select the autonomous routine without tapping through the menu, and to keep the
+// selection on the SD card.
+// The selection is read from a rotation sensor dial, where each auton owns an equal slice of a turn,
+// or from the controller by holding B and pressing a D-pad direction (up, right, down, left select
+// autons 1 to 4). Both jump straight to an auton.
+// The selection is saved to two files in turn. A save only ever overwrites the older file, so if the
+// power is lost while writing, the newer file still holds the last complete selection.
+class AutonSelector
+{
+private:
+  // The rotation sensor used as a dial.
+  rotation& dial;
+  // The dial slice the selection was last taken from, or -1 before the dial has been read.
+  int dialSlice = -1;
+  // How far in degrees the dial must be inside a new slice to select it, so the selection does not
+  // flicker when the dial rests on the edge between two slices.
+  float dialMargin = 5;
+
+  // The files of the two slots.
+  static const char* const slotFiles[2];
+  // The text file earlier versions of the template saved the selection to.
+  static const char* const legacyFile;
+  // The slot holding the newest record, and its sequence number.
+  int newestSlot = 1;
+  uint32_t sequence = 0;
+  // The time in msec a scheduled save is due, or 0 if none is scheduled.
+  uint32_t saveDueTime = 0;
+
+  // Returns the checksum of a record.
+  static uint32_t checksum(const SelectionRecord& record);
+  // Reads a slot. Returns true if it holds a complete record.
+  bool readSlot(int slot, SelectionRecord& record);
+  // Loads the selection from the legacy file and saves it to the slots. Returns false if there is none
+  // or it is out of range.
+  bool loadLegacy(int autonCount, int driveModeCount);
+
+public:
+  // The constructor for the AutonSelector class.
+  AutonSelector(rotation& dial);
+
+  // Returns the selection made with the dial or the controller, or the given selection if neither was used.
+  int poll(int selection, int autonCount);
+  // Returns true while B is held to select an auton with the D-pad, so the D-pad buttons should do nothing else.
+  bool isChordHeld();
+
+  // Saves the auton selection and drive mode. Returns true if the save succeeded.
+  bool save();
+  // Loads the newest saved auton selection and drive mode. Returns false if there is none, or if it
+  // is outside the autonCount autons and driveModeCount drive modes, e.g. after the lists were shortened.
+  // If neither slot holds a record, the selection is read once from parameters.txt of earlier versions.
+  bool load(int autonCount, int driveModeCount);
+  // Saves after a delay in msec, so turning the dial across several autons only writes once.
+  void scheduleSave(uint32_t delay = 1000);
+  // Saves if a scheduled save is due.
+  void saveIfDue();
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include "vex.h"
+#include <atomic>
+
+// A class to decide which source's commands reach the drivetrain.
+// Each source claims the drivetrain while it wants to drive it. A command is sent only if no
+// higher priority source holds a claim, so the driver loop, macros, autonomous and safety stops
+// can all command the chassis from their own threads without the motors alternating between them.
+// Each command is checked under the lock the claims take, but the lock is released before the
+// motors are commanded, so a thread killed mid-command, as field control ends autonomous, cannot
+// leave the drivetrain locked. A lower command already past the check when a higher source claims
+// can still land once, and the higher source's first command replaces it.
+class ChassisArbiter
+{
+private:
+  // The maximum number of threads that can be bound to a source.
+  static const int MAX_BOUND_THREADS = 8;
+  // The threads bound to a source and their sources. Unbound threads command as the driver.
+  int32_t boundThreads[MAX_BOUND_THREADS];
+  driveOwner boundSources[MAX_BOUND_THREADS];
+  int boundCount = 0;
+
+  // One bit per source with an active claim.
+  std::atomic<int> activeSources;
+  // Held while a claim, binding or command check reads or changes the state above.
+  vex::mutex commandLock;
+
+  // Per source counts of commands sent, commands dropped because a higher source held the
+  // drivetrain, and times the source lost the drivetrain to a higher claim.
+  std::atomic<int> commandsSent[OWNER_COUNT];
+  std::atomic<int> commandsOverridden[OWNER_COUNT];
+  std::atomic<int> preemptions[OWNER_COUNT];
+
+  // Returns the highest source in a set of claims.
+  static driveOwner highestSource(int sources);
+
+public:
+  // The constructor for the ChassisArbiter class.
+  ChassisArbiter();
+
+  // Claims the drivetrain for a source until it is released.
+  void claim(driveOwner source);
+  // Releases the claim of a source.
+  void release(driveOwner source);
+  // Returns the source whose commands currently reach the drivetrain.
+  driveOwner getWinner();
+  // Drops every claim and thread binding except the driver's claim. Call it when a period ends,
+  // since a task killed by field control never releases its claim or unbinds its thread.
+  void reset();
+
+  // Makes the chassis commands of the calling thread come from a source. Returns false, and warns
+  // on the controller, if every binding slot is taken, in which case the thread commands as the driver.
+  bool bindThread(driveOwner source);
+  // Returns the calling thread to commanding as the driver.
+  void unbindThread();
+  // Returns the source of the calling thread.
+  driveOwner getThreadSource();
+
+  // Checks a chassis command from a source and counts it. Returns true if the command may be sent.
+  bool allowCommand(driveOwner source);
+
+  // Returns the number of commands a source sent to the drivetrain.
+  int getCommandsSent(driveOwner source);
+  // Returns the number of commands from a source dropped because a higher source held the drivetrain.
+  int getCommandsOverridden(driveOwner source);
+  // Returns the number of times a source lost the drivetrain to a higher claim.
+  int getPreemptions(driveOwner source);
+  // Resets the counters.
+  void resetStats();
+  // Writes the dropped commands of the driver, macro and autonomous, for the dashboard.
+  void formatStats(char* text, int size);
+  // Shows the dropped commands of the driver, macro and autonomous on the controller screen.
+  void printStats();
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <math.h>
+
+// Float-only math for the control loops. Everything here is inline and stays in single
+// precision, so the hot loops make no double promotions and no fmod/pow library calls.
+
+// The natural log of 2.718, the base used by the joystick curve.
+constexpr float CURVE_LN_BASE = 0.99989632f;
+
+// Clamps a value between a minimum and maximum value.
+constexpr float clampf(float input, float min, float max) {
+  return input > max ? max : (input < min ? min : input);
+}
+
+// Returns zero if the input is inside the dead zone.
+inline float deadbandf(float input, float width) {
+  return fabsf(input) < width ? 0.0f : input;
+}
+
+// Converts a percentage to a voltage.
+constexpr float percentToVolt(float percent) {
+  return percent * 0.12f;
+}
+
+// Reduces an angle to the range [0, 360).
+inline float wrap360(float angle) {
+  float wrapped = angle - 360.0f * floorf(angle * (1.0f / 360.0f));
+  // Rounding in the reciprocal can land exactly on either end of the range.
+  wrapped = wrapped >= 360.0f ? wrapped - 360.0f : wrapped;
+  return wrapped < 0.0f ? wrapped + 360.0f : wrapped;
+}
+
+// Reduces an angle to the range [-180, 180).
+inline float wrap180(float angle) {
+  return wrap360(angle + 180.0f) - 180.0f;
+}
+
+// Returns the minimum gain of the joystick curve for a curve scale, i.e. 2.718^-(curveScale / 10).
+// Compute it once when the curve scale is set.
+inline float curveMinimum(float curveScale) {
+  return expf(-curveScale * 0.1f * CURVE_LN_BASE);
+}
+
+// Applies the joystick curve to a percentage: small inputs are scaled down by curveMin,
+// and the gain rises smoothly to 1 at full stick.
+inline float curve(float x, float curveMin) {
+  return (curveMin + expf((fabsf(x) - 100.0f) * 0.1f * CURVE_LN_BASE) * (1.0f - curveMin)) * x;
+}
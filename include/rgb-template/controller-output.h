@@ -0,0 +1,84 @@
+#pragma once
+#include "vex.h"
+
+// The priorities of controller screen messages. A higher priority message is shown first
+// and replaces a lower priority one that is still being held on the screen.
+enum messagePriority {
+  MESSAGE_LOW,     // statistics and telemetry
+  MESSAGE_NORMAL,  // feedback on button presses and menu changes
+  MESSAGE_HIGH     // warnings the driver must see
+};
+
+// A message waiting to be shown on the controller screen.
+struct ControllerMessage
+{
+  char text[25];
+  messagePriority priority;
+  // The time in msec the message stays on the screen before a message of the same or lower priority replaces it.
+  uint32_t holdTime;
+  // Orders messages of the same priority.
+  uint32_t sequence;
+};
+
+// A class to send text and rumble patterns to the controller from one background task.
+// Callers only queue their output and return immediately. The task sends at most one update per
+// write interval, which keeps the slow radio link from dropping updates. A message that is already
+// queued or on the screen is not queued again, and repeated rumble patterns are merged.
+class ControllerOutput
+{
+private:
+  // The maximum number of queued messages and rumble patterns.
+  static const int MAX_MESSAGES = 8;
+  static const int MAX_RUMBLES = 4;
+
+  // The queued messages.
+  ControllerMessage messages[MAX_MESSAGES];
+  int messageCount = 0;
+  uint32_t nextSequence = 0;
+  // The queued rumble patterns.
+  char rumbles[MAX_RUMBLES][9];
+  int rumbleCount = 0;
+  // Protects the queues.
+  vex::mutex queueLock;
+
+  // The message on the screen, when it was shown, and how long it is held.
+  ControllerMessage shown;
+  uint32_t shownTime = 0;
+  // The time in msec the current rumble pattern finishes.
+  uint32_t rumbleEndTime = 0;
+  // The time in msec the next update may be sent.
+  uint32_t nextWriteTime = 0;
+  // The minimum time in msec between updates sent to the controller.
+  uint32_t writeInterval = 50;
+
+  // Output statistics.
+  int messagesShown = 0;
+  int messagesCoalesced = 0;
+  int messagesDropped = 0;
+
+  // The background task that sends the queued output.
+  static int outputTask(void* output);
+  // Sends the next queued message or rumble pattern if one is due.
+  void update();
+  // Returns the index of the queued message to show next, or -1 if none can be shown yet.
+  int nextMessage(uint32_t now);
+
+public:
+  // The constructor for the ControllerOutput class.
+  ControllerOutput();
+
+  // Starts the background task.
+  void start(uint32_t writeInterval = 50);
+
+  // Queues a message for the controller screen. Returns immediately.
+  void print(const char* text, messagePriority priority = MESSAGE_NORMAL, uint32_t holdTime = 0);
+  // Queues a rumble pattern of up to 8 characters. Returns immediately.
+  void rumble(const char* pattern);
+
+  // Returns the number of messages shown.
+  int getMessagesShown();
+  // Returns the number of messages merged into one already queued or on the screen.
+  int getMessagesCoalesced();
+  // Returns the number of messages dropped because the queue was full.
+  int getMessagesDropped();
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include "vex.h"
+
+// Writes the text of a dashboard widget into a buffer of a given size.
+typedef void (*widgetFormatter)(char* text, int size);
+
+// The longest text a dashboard widget can show, including the terminating null.
+const int WIDGET_TEXT_SIZE = 32;
+
+// A box on the brain screen showing one line of text.
+struct DashboardWidget
+{
+  // The position and size of the box in pixels.
+  int x;
+  int y;
+  int width;
+  int height;
+  // The font of the text.
+  fontType font;
+  // Writes the text to show.
+  widgetFormatter format;
+
+  // The text on the screen, and whether it is on the screen at all.
+  char drawn[WIDGET_TEXT_SIZE];
+  bool valid;
+};
+
+// Creates a dashboard widget.
+DashboardWidget dashboardWidget(int x, int y, int width, int height, fontType font, widgetFormatter format);
+
+// The drawing a dashboard does, so it can draw to the brain screen or to a framebuffer on a host.
+struct DashboardCanvas
+{
+  // The screen or framebuffer drawn on, passed to each function.
+  void* target;
+  // Clears the whole screen.
+  void (*clear)(void* target);
+  // Fills a box with the background color.
+  void (*clearBox)(void* target, int x, int y, int width, int height);
+  // Draws white text with its baseline at a point.
+  void (*printText)(void* target, int x, int y, fontType font, const char* text);
+};
+
+// Returns the canvas that draws to the brain screen.
+DashboardCanvas brainScreenCanvas();
+
+// A class to show live robot data on the brain screen.
+// A low priority task formats every widget each frame but only redraws the ones whose text
+// changed, and stops drawing once a frame has used its time budget; the remaining widgets
+// are drawn first in the next frame. The screen is never cleared while the dashboard runs.
+class Dashboard
+{
+private:
+  // The widgets on the screen.
+  DashboardWidget* widgets;
+  // Where the widgets are drawn.
+  DashboardCanvas canvas;
+  // The number of widgets.
+  int widgetCount;
+  // The widget the next frame starts with.
+  int nextWidget = 0;
+
+  // The frame period in msec.
+  int period = 50;
+  // The time in usec a frame may spend drawing.
+  uint32_t frameBudget = 2000;
+
+  // Render statistics.
+  int frames = 0;
+  int widgetsRedrawn = 0;
+  int framesOverBudget = 0;
+  // The time the last frame and the slowest frame took in usec.
+  uint32_t frameTime = 0;
+  uint32_t maxFrameTime = 0;
+
+  // The background task that renders the frames.
+  static int renderTask(void* dashboard);
+  // Clears a widget's box and draws its text.
+  void draw(DashboardWidget& widget, const char* text);
+
+public:
+  // The constructor for the Dashboard class. The widgets are drawn on the brain screen.
+  Dashboard(DashboardWidget* widgets, int widgetCount);
+
+  // Draws the widgets on another canvas, e.g. a framebuffer on a host, from the next frame.
+  void setCanvas(const DashboardCanvas& canvas);
+
+  // Clears the screen and starts the background task that renders a frame every period msec.
+  void start(int period = 50, uint32_t frameBudget = 2000);
+  // Renders one frame.
+  void renderFrame();
+  // Makes the next frames redraw every widget.
+  void invalidate();
+
+  // Returns the number of frames rendered.
+  int getFrames();
+  // Returns the number of widgets redrawn.
+  int getWidgetsRedrawn();
+  // Returns the number of frames that ran out of time before all changed widgets were drawn.
+  int getFramesOverBudget();
+  // Returns the time the last frame took in usec.
+  uint32_t getFrameTime();
+  // Returns the time the slowest frame took in usec.
+  uint32_t getMaxFrameTime();
+  // Resets the render statistics.
+  void resetStats();
+};
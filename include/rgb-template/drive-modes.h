@@ -0,0 +1,134 @@
+#pragma once
+#include "vex.h"
+
+// Each drive mode is a class with a control() function that reads its joystick axes and
+// commands the drivetrain. A mode keeps references to its axes and motors, so nothing is
+// copied on each call. To add new kinematics (e.g. H-drive or X-drive), write a class with
+// a control() function and add it to the drive mode table in robot-config.cpp.
+
+// Arcade drive: one axis for forward/backward and one axis for turning.
+class ArcadeMode
+{
+private:
+  Drive& chassis;
+  vex::controller::axis& throttle;
+  vex::controller::axis& turn;
+
+public:
+  ArcadeMode(Drive& chassis, vex::controller::axis& throttle, vex::controller::axis& turn) :
+    chassis(chassis), throttle(throttle), turn(turn) {}
+
+  void control() {
+    chassis.controlArcade(throttle.position(), turn.position());
+  }
+};
+
+// Tank drive: one axis for each side of the drivetrain.
+class TankMode
+{
+private:
+  Drive& chassis;
+  vex::controller::axis& left;
+  vex::controller::axis& right;
+
+public:
+  TankMode(Drive& chassis, vex::controller::axis& left, vex::controller::axis& right) :
+    chassis(chassis), left(left), right(right) {}
+
+  void control() {
+    chassis.controlTank(left.position(), right.position());
+  }
+};
+
+// Mecanum drive: strafe, forward and turn axes mixed onto the four wheel motors.
+class MecanumMode
+{
+private:
+  Drive& chassis;
+  vex::controller::axis& strafe;
+  vex::controller::axis& throttle;
+  vex::controller::axis& straight;
+  vex::controller::axis& turn;
+  motor& driveLF;
+  motor& driveRF;
+  motor& driveLB;
+  motor& driveRB;
+
+public:
+  MecanumMode(Drive& chassis, vex::controller::axis& strafe, vex::controller::axis& throttle,
+              vex::controller::axis& straight, vex::controller::axis& turn,
+              motor& driveLF, motor& driveRF, motor& driveLB, motor& driveRB) :
+    chassis(chassis), strafe(strafe), throttle(throttle), straight(straight), turn(turn),
+    driveLF(driveLF), driveRF(driveRF), driveLB(driveLB), driveRB(driveRB) {}
+
+  void control() {
+    chassis.controlMecanum(strafe.position(), throttle.position(), straight.position(), turn.position(),
+                           driveLF, driveRF, driveLB, driveRB);
+  }
+};
+
+// Calls the control() function of a specific drive mode class.
+template <class Mode>
+void controlDriveMode(void* mode) {
+  static_cast<Mode*>(mode)->control();
+}
+
+// An entry in the drive mode table.
+struct DriveModeEntry
+{
+  // The name shown on the controller screen.
+  const char* name;
+  // The drive mode object.
+  void* mode;
+  // The control path specialized for the type of the drive mode object.
+  void (*control)(void* mode);
+  // The acceleration limits and tip prevention applied while the mode is selected.
+  DriveLimits limits;
+};
+
+// Creates a drive mode table entry for a drive mode object.
+template <class Mode>
+DriveModeEntry driveModeEntry(const char* name, Mode& mode, const DriveLimits& limits = NO_DRIVE_LIMITS) {
+  DriveModeEntry entry = {name, &mode, controlDriveMode<Mode>, limits};
+  return entry;
+}
+
+// A class to select the active drive mode from a table.
+// The control path is looked up once when the mode changes, so each driver
+// control tick is a single call with no branching on the mode.
+class DriveModes
+{
+private:
+  // The table of available drive modes.
+  const DriveModeEntry* modes;
+  // The number of drive modes in the table.
+  int modeCount;
+  // The index of the selected drive mode, or -1 if driving is disabled.
+  int selected = -1;
+  // The control path and object of the selected drive mode.
+  void (*activeControl)(void* mode);
+  void* activeMode = nullptr;
+
+  // The control path used when driving is disabled.
+  static void controlNothing(void* mode) {}
+
+public:
+  // The constructor for the DriveModes class.
+  DriveModes(const DriveModeEntry* modes, int modeCount) :
+    modes(modes), modeCount(modeCount), activeControl(controlNothing) {}
+
+  // Selects a drive mode by index, wrapping past the end of the table to the first mode, and applies
+  // its acceleration limits to the chassis. -1 disables driving. Returns the selected index.
+  int select(int index);
+  // Returns the index of the selected drive mode.
+  int getSelected();
+  // Returns the name of the selected drive mode.
+  const char* getName();
+  // Returns the number of drive modes.
+  int getCount();
+
+  // Runs one tick of the selected drive mode.
+  void control() {
+    activeControl(activeMode);
+  }
+};
@@ -0,0 +1,123 @@
+#pragma once
+#include "vex.h"
+
+// Disturbances applied to the drivetrain's sensors and outputs to test how an auton copes with them.
+struct Perturbation
+{
+  // The share of the commanded voltage that reaches the motors, e.g. 0.85 for a low battery.
+  float voltageScale;
+  // The encoder reading per inch the robot really moves, e.g. 1.05 for 5% wheel slip.
+  float encoderScale;
+  // The gyro drift in deg/sec and the largest random noise in deg added to each heading reading.
+  float headingDrift;
+  float headingNoise;
+};
+
+// No disturbance.
+const Perturbation NO_PERTURBATION = {1, 1, 0, 0};
+
+// A drivetrain simulated from a feedforward model, stepped once per control tick. The motions run on it
+// through the chassis unchanged, so it measures the control code, not the robot, and gives the same
+// result on every run.
+class DriveSimulation
+{
+private:
+  // The time in sec of each control tick, and the integration steps in each tick.
+  static constexpr float TICK = 0.01f;
+  static const int SUBSTEPS = 5;
+  // A motion that has not ended after this many ticks is stopped.
+  static const int MAX_TICKS = 3000;
+
+  // The plant. Driving straight and turning in place are simulated separately, each with its own constants.
+  DriveModel model;
+  // The speed in inch/sec and turn rate in deg/sec.
+  float velocity = 0;
+  float turnRate = 0;
+  // The positions of the sides in inches and the heading in deg, not wrapped.
+  float leftPosition = 0;
+  float rightPosition = 0;
+  float heading = 0;
+  // The voltages commanded to each side.
+  float leftVoltage = 0;
+  float rightVoltage = 0;
+
+  // The disturbance of the plant and its sensors, and the gyro drift in deg since the heading was last set.
+  Perturbation perturbation = NO_PERTURBATION;
+  float headingDriftTotal = 0;
+  // Where the robot really is on the field in inches, and where its encoders and gyro put it.
+  float x = 0;
+  float y = 0;
+  float sensedX = 0;
+  float sensedY = 0;
+
+  // The number of ticks stepped.
+  int ticks = 0;
+  // The clock the control code is timed on in nsec, the time it ran between ticks, and when the last tick ended.
+  uint64_t (*clock)() = systemClock;
+  uint64_t controlTime = 0;
+  uint64_t lastStepEnd = 0;
+
+  // The target being tracked: inches driven, or deg turned if turning.
+  bool tracking = false;
+  bool turning = false;
+  float target = 0;
+  float trackStart = 0;
+  // The furthest progress towards the target, and the tick the robot first came within 1 inch or deg of it.
+  float peakProgress = 0;
+  int arrivalTick = -1;
+
+  // Returns the time in nsec of the brain's microsecond timer.
+  static uint64_t systemClock();
+  // Returns a speed after one integration step at a voltage.
+  float accelerate(float speed, float voltage, float kS, float kV, float kA, float dt);
+
+public:
+  // Starts a new run on a model with the robot at rest and undisturbed, and stops tracking a target.
+  void reset(const DriveModel& model);
+  // Disturbs the plant and its sensors until the next reset.
+  void setPerturbation(const Perturbation& perturbation);
+  // Times the control code on a clock in nsec, e.g. the CPU time of the thread on a host, or on the brain's
+  // timer if nullptr.
+  void setClock(uint64_t (*clock)());
+  // Tracks the progress of a drive in inches or a turn in deg from where the robot is now.
+  void setTarget(bool turning, float target);
+
+  // Moves the simulation on by one control tick.
+  void step();
+  // Sets the voltages of the sides.
+  void setVoltage(float leftVoltage, float rightVoltage);
+  // Stops the sides. brake and hold stop the robot at once, coast lets it roll.
+  void stop(vex::brakeType mode);
+  // Zeros the positions of the sides.
+  void resetPosition();
+  // Sets the heading in deg.
+  void setHeading(float heading);
+
+  // Returns the heading in deg as the gyro reads it.
+  float getHeading();
+  // Returns the positions of the sides in inches as the encoders read them.
+  float getLeftPosition();
+  float getRightPosition();
+  // Returns the velocities of the sides in inch/sec as the encoders read them.
+  float getLeftVelocity();
+  float getRightVelocity();
+  // Returns the heading in deg the robot really has.
+  float getTrueHeading();
+  // Returns where the robot really is on the field in inches, from where it was reset, with heading 0 along y.
+  float getTrueX();
+  float getTrueY();
+  // Returns the distance in inches between where the robot really is and where its sensors put it.
+  float getPoseError();
+
+  // Returns the inches driven or deg turned towards the target since it was set.
+  float getProgress();
+
+  // Returns the number of ticks stepped.
+  int getTicks();
+  // Returns the time in usec the control code ran per tick.
+  float getTickCpuTime();
+  // Returns how far in inches or deg the robot went past the target.
+  float getOvershoot();
+  // Returns the ticks from first coming within 1 inch or deg of the target until the motion ended.
+  int getSettleTicks();
+};
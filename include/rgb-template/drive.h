@@ -1,7 +1,67 @@
 #pragma once
 #include "vex.h"
+#include "rgb-template/motion-profile.h"
 #include <string>
 
+// The turn gains and rotational profile used for turns up to a size in degrees.
+struct TurnGains
+{
+  float maxAngle;
+  float kp;
+  float ki;
+  float kd;
+  float starti;
+  // The peak turn rate in deg/sec and the angular acceleration in deg/sec^2.
+  float maxVelocity;
+  float acceleration;
+};
+
+// Forward declaration of the DriveSimulation class.
+class DriveSimulation;
+
+// The acceleration limits and tip prevention of a drive mode.
+// The acceleration limits are in volts above or below the voltage that holds the wheel's current speed,
+// so they limit torque rather than output: a wheel that is already moving gets its full voltage at once.
+struct DriveLimits
+{
+  // The most volts that speed a wheel up, and the most that slow it down or reverse it.
+  float maxAccelVoltage;
+  float maxDecelVoltage;
+  // Tip prevention starts when the pitch or roll passes this many degrees. 0 turns it off.
+  float tipAngle;
+  // The volts per degree past tipAngle that drive the wheels back under the robot.
+  // The pitch is positive with the front up; use a negative gain if the inertial sensor faces backwards.
+  float tipGain;
+};
+
+// No acceleration limit or tip prevention.
+const DriveLimits NO_DRIVE_LIMITS = {24, 24, 0, 0};
+
+// The side of the drivetrain that drives during a swing turn. The other side holds its position.
+enum swingSide {
+  SWING_LEFT,
+  SWING_RIGHT
+};
+
+// The kinds of motion in a chain.
+enum chainMotion {
+  CHAIN_DRIVE,  // drives a distance while holding a heading
+  CHAIN_TURN    // turns in place to a heading
+};
+
+// One segment of a chained motion.
+struct ChainSegment
+{
+  chainMotion motion;
+  // The distance in inches to drive, or the heading to turn to.
+  float target;
+  // The heading to hold while driving. Unused by turns.
+  float heading;
+  // The peak speed in inch/sec and the acceleration in inch/sec^2 of a drive. Unused by turns.
+  float maxVelocity;
+  float acceleration;
+};
+
 // A class to control the robot's drivetrain.
 class Drive
 {
@@ -25,6 +85,16 @@ private:
   float turnSettleTime = 200;
   float turnTimeout = 1500;
 
+  // The turn gains scheduled by turn size, from the smallest turn to the largest. Turns use the
+  // single set of PID constants above when no schedule is set.
+  const TurnGains* turnSchedule = nullptr;
+  int turnScheduleSize = 0;
+  // Feedforward constants for following a turn profile: volts to overcome static friction,
+  // volts per deg/sec and volts per deg/sec^2.
+  float turnKs = 0;
+  float turnKv = 0;
+  float turnKa = 0;
+
   // PID constants for driving.
   float driveMaxVoltage;
   float driveKp;
@@ -37,33 +107,128 @@ private:
   float driveSettleTime = 200;
   float driveTimeout = 2000;
 
+  // Feedforward constants for following a drive profile: volts to overcome static friction,
+  // volts per inch/sec and volts per inch/sec^2.
+  float driveKs = 0;
+  float driveKv = 0;
+  float driveKa = 0;
+
+  // PID constants for swing turns. Only one side drives, so swings need more gain than point turns.
+  float swingMaxVoltage = 10;
+  float swingKp = 0.4;
+  float swingKi = 0;
+  float swingKd = 4;
+  float swingStarti = 0;
+
+  // swing exit conditions.
+  float swingSettleError = 1.5;
+  float swingSettleTime = 200;
+  float swingTimeout = 1500;
+
+  // The distance in inches between the centers of the left and right wheels, used to split the
+  // drive voltage between the sides on an arc.
+  float trackWidth = 12;
+
+  // arc exit conditions, on the distance along the arc.
+  float arcSettleError = 1;
+  float arcSettleTime = 200;
+  float arcTimeout = 2500;
+
+  // The most segments a chain can have.
+  static const int MAX_CHAIN_SEGMENTS = 32;
+  // Chained drives slow to a stop at a heading change of chainCornerAngle degrees or more,
+  // and blend into the new heading over the first chainBlendDistance inches.
+  float chainCornerAngle = 90;
+  float chainBlendDistance = 6;
+
   // PID constants for maintaining heading while driving.
   float headingMaxVoltage;
   float headingKp;
   float headingKd;
 
   // Constants for arcade drive.
-  float kBrake = 0.5;
   float kTurnBias = 0.5; 
   float kTurnDampingFactor = 0.85;
 
   // allows for a non-proportional steering response
   float kThrottle = 5;
   float kTurn = 10;
+  // The minimum gains of the throttle and turn curves, computed once from kThrottle and kTurn.
+  float throttleCurveMin;
+  float turnCurveMin;
 
   // The default brake type for the drivetrain.
   vex::brakeType stopMode = coast;
+  // The acceleration limits and tip prevention of the driver control functions, set by the drive mode.
+  DriveLimits driveLimits = NO_DRIVE_LIMITS;
+
+  // Active brake: when the sticks are released, each side is slowed by a velocity loop until it comes
+  // to rest, then held there by a position loop, for activeBrakeTime msec. The gains are scaled by the
+  // speed at release over kBrakeFullSpeed, down to kBrakeMinScale, so a slow release does not jerk.
+  // kBrake is in volts per inch and kBrakeDamping in volts per inch/sec.
+  float kBrake = 2;
+  float kBrakeDamping = 0.4;
+  float kBrakeFullSpeed = 30;
+  float kBrakeMinScale = 0.3;
+  float activeBrakeTime = 500;
+  // The state of the active brake.
+  bool braking = false;
+  float brakeEndTime = 0;
+  float brakeScale = 1;
+  float brakeLeftTarget = 0;
+  float brakeRightTarget = 0;
+  bool brakeLeftLatched = false;
+  bool brakeRightLatched = false;
+
+  // The simulated drivetrain the motions run on while benchmarking, or nullptr.
+  DriveSimulation* simulation = nullptr;
 
   // The motor group for the left side of the drivetrain.
   motor_group leftDrive;
   // The motor group for the right side of the drivetrain.
   motor_group rightDrive;
 
-    // Gets the position of the left side of the drivetrain in inches.
-  float getLeftPositionIn();
-  // Gets the position of the right side of the drivetrain in inches.
-  float getRightPositionIn();
-  
+
+  // Returns the voltage for a wheel moving at a velocity in inch/sec, limited to the drive mode's
+  // acceleration and corrected by tipCorrection.
+  float limitAcceleration(float voltage, float velocity, float tipCorrection);
+  // Returns the acceleration voltage that lowers the robot when the pitch is past the tip angle, or 0.
+  float getTipCorrection();
+  // Returns the share of the turn to keep when the roll is past the tip angle.
+  float getTurnScale();
+  // Returns the velocity of a wheel in inch/sec.
+  float getWheelVelocity(motor& wheel);
+  // Returns the velocity of each side in inch/sec, from the simulation while simulating.
+  float getLeftVelocityIn();
+  float getRightVelocityIn();
+  // Returns the time in msec the active brake is timed on, counted in simulated ticks while simulating.
+  float getControlTime();
+  // Drives and stops the sides for the arcade and tank controls, on the simulation while simulating.
+  // Unlike driveWithVoltage, they are not arbitrated or logged, as the driver loop already holds the drivetrain.
+  void driveSides(float leftVoltage, float rightVoltage);
+  void stopSides(vex::brakeType mode);
+
+  // Starts the active brake with gains scaled by the speed at release.
+  void startActiveBrake();
+  // Runs one tick of the active brake. Returns immediately, so it never holds up the driver loop.
+  void updateActiveBrake();
+  // Returns the voltage that brakes one side: damping until the side comes to rest, then a hold at that position.
+  float brakeOutput(float position, float velocity, float& target, bool& latched);
+
+  // Waits for the next control tick. While replaying a motion log, moves to the next logged tick instead,
+  // and while simulating, steps the simulation.
+  void waitTick();
+  // Stops the drive motors if the calling thread's source holds the drivetrain.
+  void stopMotors(vex::brakeType mode);
+  // Drives one side of the drivetrain with a voltage and holds the other side.
+  void swingWithVoltage(swingSide side, float voltage);
+
+  // Turns the robot to a heading along a rotational profile, with the gains scheduled by turn size.
+  // A chained turn returns as soon as the profile has ended inside the settle error.
+  void turnProfiled(float heading, float turnMaxVoltage, float earlyExitFactor, bool chained = false);
+  // Drives one segment of a chain from its planned start position, blending from the previous heading.
+  // previousError carries the tracking error across the junction. Returns the planned end position.
+  float driveChainSegment(const ProfileSpec& spec, float startHeading, float endHeading, float startPosition, float& previousError, bool chained);
 
   // Drives the robot a specific distance while significantly slowing down when approaching target
   void driveDistance(float distance, float driveMaxVoltage, float heading, float headingMaxVoltage, float slowDownDistance, float slowDownVoltage);
@@ -73,48 +238,90 @@ public:
   // The inertial sensor.
   inertial gyro;
 
-// The desired heading of the robot.
-  float desiredHeading;
-
   // The constructor for the Drive class.
   Drive(motor_group leftDrive, motor_group rightDrive, inertial gyro, float wheelDiameter, float gearRatio);
 
   // Gets the current heading of the robot.
   float getHeading();
+  // Gets the distance in inches driven since the drivetrain was last stopped.
+  float getDistanceTraveled();
+  // Gets the position of the left side of the drivetrain in inches.
+  float getLeftPositionIn();
+  // Gets the position of the right side of the drivetrain in inches.
+  float getRightPositionIn();
+  // Runs the motions on a simulated drivetrain instead of the motors and sensors. nullptr returns to the robot.
+  void setSimulation(DriveSimulation* simulation);
+  // Gets the maximum voltage of the heading correction while driving.
+  float getHeadingMaxVoltage();
   // Sets the current heading of the robot.
   void setHeading(float orientationDeg);
 
   // Drives the robot with a specific voltage for each side of the drivetrain.
   void driveWithVoltage(float leftVoltage, float rightVoltage);
+  // Waits a time in msec. Autons wait with this instead of wait(), so a simulated drivetrain moves on
+  // by the same time in ticks. While replaying a motion log it returns at once, as the log holds no ticks for it.
+  void waitTime(float time);
 
   // Turns the robot to a specific heading.
   void turnToHeading(float heading);
 
+  // Turns the robot to a heading by driving one side and holding the other.
+  void swingToHeading(float heading, swingSide side);
+  // Drives the robot along an arc of a radius in inches, turning by an angle in degrees (positive turns right).
+  // A negative radius drives the arc backwards. The heading PID holds the robot on the curve.
+  void driveArc(float radius, float angle);
+
   // Drives the robot a specific distance.
   void driveDistance(float distance);
   // Drives the robot a specific distance with a maximum voltage.
   void driveDistance(float distance, float driveMaxVoltage);
+  // Drives the robot along a motion profile from the trajectory cache, holding the desired heading.
+  void driveProfile(const ProfileSpec& spec);
+  // Drives the robot along a motion profile from the trajectory cache with a maximum voltage.
+  void driveProfile(const ProfileSpec& spec, float driveMaxVoltage);
 
-  // A flag to indicate if the drivetrain needs to be stopped.
-  bool drivetrainNeedsStopped = false;
-  bool joystickTouched = false;
+  // Runs a list of drives and turns as one continuous motion. Consecutive drives in the same direction
+  // hand their speed over at each junction instead of stopping, and each segment starts from where the
+  // previous one was planned to end, so tracking error carries over rather than restarting.
+  void driveChain(const ChainSegment* segments, int segmentCount);
 
+  // The control functions write the motors directly, so the driver loop runs them inside a chassis arbiter command.
+  // The arcade and tank controls run on the simulation while one is set.
   // Controls the robot in arcade mode.
   void controlArcade(int throttle, int turn);
   // Controls the robot in tank mode.
   void controlTank(int left, int right);
-  void controlMecanum(int x, int y, int acc, int steer, motor DriveLF, motor DriveLR, motor DriveRF, motor DriveRB);
+  // Controls the robot in mecanum mode.
+  void controlMecanum(int x, int y, int acc, int steer, motor& driveLF, motor& driveRF, motor& driveLB, motor& driveRB);
 
   // Sets the PID constants for driving.
   void setDrivePID(float driveMaxVoltage, float driveKp, float driveKi, float driveKd, float driveStarti);
   // Sets the exit conditions for driving.
   void setDriveExitConditions(float driveSettleError, float driveSettleTime, float driveTimeout);
+  // Sets the feedforward constants for following drive profiles.
+  void setDriveFeedforward(float driveKs, float driveKv, float driveKa);
   // Sets the PID constants for maintaining heading.
   void setHeadingPID(float headingMaxVoltage, float headingKp, float headingKd);
   // Sets the exit conditions for turning.
   void setTurnExitConditions(float turnSettleError, float turnSettleTime, float turnTimeout);
   // Sets the PID constants for turning.
   void setTurnPID(float turnMaxVoltage, float turnKp, float turnKi, float turnKd, float turnStarti); 
+  // Sets the turn gains scheduled by turn size. The table must stay valid and be sorted by maxAngle.
+  void setTurnSchedule(const TurnGains* turnSchedule, int turnScheduleSize);
+  // Sets the feedforward constants for following turn profiles.
+  void setTurnFeedforward(float turnKs, float turnKv, float turnKa);
+  // Sets the PID constants for swing turns.
+  void setSwingPID(float swingMaxVoltage, float swingKp, float swingKi, float swingKd, float swingStarti);
+  // Sets the exit conditions for swing turns.
+  void setSwingExitConditions(float swingSettleError, float swingSettleTime, float swingTimeout);
+  // Sets the distance between the centers of the left and right wheels.
+  void setTrackWidth(float trackWidth);
+  // Sets the exit conditions for arcs.
+  void setArcExitConditions(float arcSettleError, float arcSettleTime, float arcTimeout);
+  // Sets the acceleration limits and tip prevention of the driver control functions.
+  void setDriveLimits(const DriveLimits& driveLimits);
+  // Sets how the active brake slows and holds the drivetrain after the sticks are released.
+  void setActiveBrake(float kBrakeDamping, float kBrakeFullSpeed, float activeBrakeTime);
   // Sets the constants for arcade drive.
   void setArcadeConstants(float kBrake, float kTurnBias, float kTurnDampingFactor);
 
@@ -127,5 +334,9 @@ public:
   void turnToHeading(float heading, float turnMaxVoltage, float earlyExitFactor = 1);
     // earlyExitFactor: nonstopping if greater than 1. Maxium is 5.
   void driveDistance(float distance, float driveMaxVoltage, float heading, float headingMaxVoltage,  float earlyExitFactor = 1);
+    // earlyExitFactor: nonstopping if greater than 1. Maxium is 5.
+  void swingToHeading(float heading, swingSide side, float swingMaxVoltage, float earlyExitFactor = 1);
+    // earlyExitFactor: nonstopping if greater than 1. Maxium is 5.
+  void driveArc(float radius, float angle, float driveMaxVoltage, float earlyExitFactor = 1);
 
 };
\ No newline at end of file
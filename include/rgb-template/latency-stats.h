@@ -0,0 +1,34 @@
+#pragma once
+#include "vex.h"
+
+// A class to collect latency samples in a fixed histogram and report percentiles.
+// Recording a sample is constant time and allocates nothing, so it can run inside a control loop.
+class LatencyStats
+{
+private:
+  // The number of histogram bins. Samples beyond the last bin are counted in it.
+  static const int BIN_COUNT = 100;
+  // The width of each bin in usec.
+  float binWidth;
+  // The number of samples in each bin.
+  int bins[BIN_COUNT];
+  // The number of samples recorded.
+  int count = 0;
+  // The largest sample recorded in usec.
+  float maxLatency = 0;
+
+public:
+  // The constructor for the LatencyStats class.
+  LatencyStats(float binWidth = 250);
+
+  // Records a latency sample in usec.
+  void record(float latency);
+  // Returns the latency in usec below which the given percentage of samples fall.
+  float percentile(float percent);
+  // Returns the largest sample recorded in usec.
+  float getMax();
+  // Returns the number of samples recorded.
+  int getCount();
+  // Clears all samples.
+  void reset();
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include "vex.h"
+
+// A class to run a control loop at a fixed rate.
+// Ticks are scheduled from the previous scheduled time rather than from when the loop
+// body finished, so the rate does not drift with the time spent in the loop body.
+class LoopTimer
+{
+private:
+  // The loop period in msec.
+  uint32_t period;
+  // The system time in msec at which the next tick is due.
+  uint32_t nextTick = 0;
+
+  // The lateness of the last tick and the worst lateness seen, in usec.
+  float jitter = 0;
+  float maxJitter = 0;
+  // The number of ticks whose loop body took longer than the period.
+  int overruns = 0;
+
+public:
+  // The constructor for the LoopTimer class.
+  LoopTimer(uint32_t period);
+
+  // Sets the loop period in msec.
+  void setPeriod(uint32_t period);
+  // Gets the loop period in msec.
+  uint32_t getPeriod();
+  // Starts the schedule from the current time.
+  void start();
+  // Sleeps until the next tick is due.
+  void waitForNextTick();
+
+  // Returns the lateness of the last tick in usec.
+  float getJitter();
+  // Returns the worst lateness seen since the last reset in usec.
+  float getMaxJitter();
+  // Returns the number of overruns since the last reset.
+  int getOverruns();
+  // Resets the jitter and overrun statistics.
+  void resetStats();
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include "vex.h"
+#include <atomic>
+
+// A function run as one step of a macro. Returns false to end the macro early.
+typedef bool (*macroStepFunction)(float value);
+
+// A step of a macro: the function to run and the value passed to it.
+struct MacroStep
+{
+  macroStepFunction run;
+  float value;
+};
+
+// A class to run scripted multi-step macros during driver control on their own thread.
+// A running macro is cancelled as soon as the driver touches a joystick: the current
+// chassis motion exits on its next loop iteration and no further steps are run.
+class MacroRunner
+{
+private:
+  // The steps of the running macro.
+  const MacroStep* steps = nullptr;
+  // The number of steps in the running macro.
+  int stepCount = 0;
+  // Puts the mechanisms back in a safe state if the running macro does not finish, or nullptr.
+  void (*onCancel)() = nullptr;
+  // True once the running macro has been cancelled.
+  std::atomic<bool> cancelled;
+
+  // The thread that runs the macro steps in order.
+  static int macroTask(void* runner);
+
+public:
+  // The constructor for the MacroRunner class.
+  MacroRunner();
+
+  // Starts running a macro. onCancel runs on the macro's thread if it is cancelled or a step ends it early.
+  // Returns false if another macro is already running or a higher source holds the drivetrain.
+  bool start(const MacroStep* steps, int stepCount, void (*onCancel)() = nullptr);
+  // Cancels the running macro.
+  void cancel();
+  // Returns true while a macro is running.
+  bool isRunning();
+  // Returns true if the running macro has been cancelled.
+  bool isCancelled();
+};
+
+// Macro step: turns the robot to a heading.
+bool macroTurnToHeading(float heading);
+// Macro step: drives the robot a distance in inches.
+bool macroDriveDistance(float distance);
+// Macro step: waits for a time in msec.
+bool macroWait(float time);
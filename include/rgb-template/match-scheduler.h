@@ -0,0 +1,72 @@
+#pragma once
+#include "vex.h"
+#include <atomic>
+
+// A function run by the match scheduler at a match time.
+typedef void (*matchEventFunction)();
+
+// An action scheduled at a time in msec from the start of driver control.
+struct MatchEvent
+{
+  matchEventFunction run;
+  // The match time of the first run, and the time in msec between runs. 0 runs it once.
+  uint32_t time;
+  uint32_t interval;
+  // The match time of the next run.
+  uint32_t nextTime;
+  // True once an event that runs once has run.
+  bool done;
+};
+
+// A class to run timed driver aids, such as endgame warnings and motor health checks, from one
+// background task. The task sleeps until the next event is due instead of polling, and starting a new
+// match restarts the clock rather than starting another task. Event actions run on the scheduler's
+// thread and must return quickly; queue controller output instead of waiting on it.
+// There is one match clock, so there is one scheduler, reached through MatchScheduler::instance().
+class MatchScheduler
+{
+private:
+  // The only scheduler.
+  static MatchScheduler onlyInstance;
+
+  // The maximum number of scheduled events.
+  static const int MAX_EVENTS = 16;
+  // The longest time in msec the task sleeps, so events scheduled while it sleeps are not missed.
+  static const uint32_t MAX_SLEEP = 20;
+
+  // The scheduled events.
+  MatchEvent events[MAX_EVENTS];
+  int eventCount = 0;
+  // Protects the events.
+  vex::mutex eventLock;
+
+  // The system time in usec the match clock started.
+  uint64_t startTime = 0;
+  // True while the match clock runs.
+  std::atomic<bool> running;
+  // True once the background task has been started.
+  std::atomic<bool> taskStarted;
+
+  // The constructor for the MatchScheduler class. Use instance() instead.
+  MatchScheduler();
+
+  // The background task that runs the events.
+  static int schedulerTask(void* scheduler);
+  // Runs the events that are due and returns the time in msec until the next one.
+  uint32_t runDueEvents();
+
+public:
+  // Returns the only scheduler.
+  static MatchScheduler& instance();
+
+  // Schedules an action at a time in msec from the start of driver control, repeating every interval msec
+  // if the interval is not 0. Returns false if the schedule is full.
+  bool schedule(uint32_t time, matchEventFunction run, uint32_t interval = 0);
+  // Starts the match clock, and the background task the first time it is called.
+  // Calling it again restarts the clock and runs every event again.
+  void start();
+  // Stops the match clock. No events run until it is started again.
+  void stop();
+  // Returns the time in msec since the match clock started.
+  uint32_t getMatchTime();
+};
@@ -0,0 +1,109 @@
+#pragma once
+#include "vex.h"
+
+// The sensor readings a motion function used in one control tick, and the voltages it commanded.
+struct MotionSample
+{
+  float heading;
+  float leftPosition;
+  float rightPosition;
+  float leftVoltage;
+  float rightVoltage;
+  // The front distance sensor's reading in inches, which macros drive from, or 0 if it was not read.
+  float frontDistance;
+};
+
+// The contents of a motion log. It is one contiguous block, so it is saved to and loaded
+// from the SD card as is.
+struct MotionLogStore
+{
+  // 3000 samples hold 30 sec of motion at one sample per 10 msec tick, 72 KB.
+  static const int MAX_SAMPLES = 3000;
+
+  // Identifies a log written by this version of the recorder.
+  uint32_t magic;
+  // The auton that was running when the log was recorded.
+  int autonSelection;
+  int sampleCount;
+  MotionSample samples[MAX_SAMPLES];
+};
+
+// A class to record the drivetrain's sensor readings and commands during an auton, and to replay
+// them through the motion functions later.
+// While recording, each drive command is logged with the heading and positions the motion function
+// read in that tick. Only the thread that started the recording is logged, so the dashboard and the
+// driver loop reading the sensors at the same time do not get into the log. While replaying, the drivetrain reads its sensors from the log instead, does not
+// wait between ticks, and compares each command with the one recorded, so a tuning change can be
+// checked against a real run many times faster than the run took. The motors are not driven.
+class MotionLog
+{
+private:
+  // The recorded samples.
+  MotionLogStore store;
+  // Whether a log is being recorded or replayed.
+  bool recording = false;
+  bool replaying = false;
+  // The thread being recorded, and the sensor readings it took since its last command.
+  int32_t recordingThread = 0;
+  MotionSample reading;
+
+  // Returns true if the calling thread is being recorded.
+  bool isRecordingThread();
+  // The sample the replay is reading.
+  int cursor = 0;
+
+  // The command difference in volts that counts as a divergence from the log.
+  float divergenceThreshold = 0.5;
+  // The first tick that diverged, or -1, and the largest difference in volts.
+  int firstDivergence = -1;
+  float maxDivergence = 0;
+  // The number of commands compared.
+  int comparedCount = 0;
+
+public:
+  // The constructor for the MotionLog class.
+  MotionLog();
+
+  // Starts a new log for an auton running on the calling thread.
+  void startRecording(int autonSelection);
+  // Stops recording. The log is kept until the next recording or load.
+  void stopRecording();
+  // Returns true while recording.
+  bool isRecording();
+  // Notes a sensor reading of the recorded thread, to be logged with its next command.
+  void noteHeading(float heading);
+  void noteLeftPosition(float leftPosition);
+  void noteRightPosition(float rightPosition);
+  void noteFrontDistance(float frontDistance);
+  // Logs one tick of the recorded thread: its command and the readings it took. Stops adding samples when the log is full.
+  void record(float leftVoltage, float rightVoltage);
+
+  // Writes the log to the SD card. Returns false if it could not be written.
+  bool save(const char* fileName);
+  // Reads a log from the SD card. Returns false if there is no valid log.
+  bool load(const char* fileName);
+  // Returns the auton the log was recorded from.
+  int getAutonSelection();
+  // Returns the number of samples in the log.
+  int getSampleCount();
+
+  // Starts replaying the log from its first sample.
+  void startReplay();
+  // Stops replaying.
+  void stopReplay();
+  // Returns true while replaying.
+  bool isReplaying();
+  // Returns the sample the replay is reading.
+  const MotionSample& current();
+  // Compares a command with the one recorded at the replay's tick.
+  void compare(float leftVoltage, float rightVoltage);
+  // Moves the replay to the next tick. Returns false once the log is used up.
+  bool advance();
+
+  // Returns the first tick that diverged from the log, or -1.
+  int getFirstDivergence();
+  // Returns the largest command difference in volts.
+  float getMaxDivergence();
+  // Shows where the replay diverged from the log on the controller.
+  void printReport();
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include "vex.h"
+
+// The time in sec between the samples of a motion profile, one control loop tick.
+const float PROFILE_DT = 0.01f;
+
+// The constraints of a trapezoidal motion profile. Distances are in inches for drives and degrees
+// for turns, and velocities and accelerations are per second.
+struct ProfileSpec
+{
+  // The signed distance to travel.
+  float distance;
+  // The fastest speed the profile cruises at.
+  float maxVelocity;
+  // The rate the speed rises and falls at.
+  float acceleration;
+  // The speed at the start and the end, in the direction of travel. Zero for a move that starts or ends at rest.
+  float startVelocity;
+  float endVelocity;
+};
+
+// The target of one tick of a motion profile.
+struct ProfileSample
+{
+  // The distance from the start of the profile.
+  float position;
+  // The speed at that point.
+  float velocity;
+};
+
+// Returns true if two profile specs describe the same profile.
+bool sameProfile(const ProfileSpec& a, const ProfileSpec& b);
+// Returns the time in sec a profile takes.
+float profileDuration(const ProfileSpec& spec);
+// Returns the target of a profile at a time in sec from its start. Use it for moves whose profile
+// depends on where the robot is, such as turns, instead of storing the samples.
+ProfileSample profileAt(const ProfileSpec& spec, float time);
+// Returns the number of samples in a profile.
+int profileSampleCount(const ProfileSpec& spec);
+// Writes the samples of a profile, one per tick after the start. The last sample is the end of the move.
+// Returns the number of samples written, or 0 if they do not fit.
+int generateProfile(const ProfileSpec& spec, ProfileSample* samples, int maxSamples);
@@ -0,0 +1,70 @@
+#pragma once
+#include "vex.h"
+#include <atomic>
+
+// The sources that can command the drivetrain, in priority order: a higher source's commands win.
+enum driveOwner { OWNER_NONE, OWNER_DRIVER, OWNER_MACRO, OWNER_AUTON, OWNER_SAFETY, OWNER_COUNT };
+
+// A consistent copy of the shared robot state, taken once per control tick.
+struct RobotStateSnapshot
+{
+  bool drivetrainNeedsStopped;
+  bool joystickTouched;
+  float desiredHeading;
+  int driveMode;
+  int autonSelection;
+  int autonTestStep;
+  bool macroRunning;
+  bool teamIsRed;
+  driveOwner drivetrainOwner;
+};
+
+// A class to hold the state shared between the control loop, button callbacks, timers and autonomous.
+// Every field is atomic, so any thread can read or write it. The control loop takes a snapshot
+// once per tick so all of its decisions in that tick see the same values, and other threads can
+// read the last published snapshot without blocking the control loop.
+class RobotState
+{
+private:
+  // The two snapshot buffers. The control loop writes one while readers copy the other.
+  RobotStateSnapshot snapshots[2];
+  // The index of the last published snapshot.
+  std::atomic<int> publishedSnapshot;
+  // Incremented on every publish, so readers can detect that a copy was overwritten.
+  std::atomic<uint32_t> snapshotSequence;
+  // The number of times a reader had to copy the snapshot again because it was overwritten.
+  std::atomic<int> snapshotRetries;
+
+public:
+  // Set to stop a running chassis motion. Also set by the drive modes while the driver is driving.
+  std::atomic<bool> drivetrainNeedsStopped;
+  // True once the driver has touched a joystick in driver control.
+  std::atomic<bool> joystickTouched;
+  // The heading the chassis holds while driving.
+  std::atomic<float> desiredHeading;
+  // The selected drive mode, -1 if driving is disabled.
+  std::atomic<int> driveMode;
+  // The selected autonomous routine, -1 for the quick test.
+  std::atomic<int> autonSelection;
+  // The current step of the autonomous routine being tested.
+  std::atomic<int> autonTestStep;
+  // True while a driver-control macro is running.
+  std::atomic<bool> macroRunning;
+  // The team color, set from the optical sensor next to the license plate.
+  std::atomic<bool> teamIsRed;
+  // The source whose commands reach the drivetrain, published by the chassis arbiter.
+  std::atomic<int> drivetrainOwner;
+
+  // The constructor for the RobotState class, taking the starting drive mode and auton selection.
+  RobotState(int driveMode, int autonSelection);
+
+  // Publishes a snapshot of the current state. Call once at the start of each control tick.
+  const RobotStateSnapshot& snapshot();
+  // Returns a copy of the last published snapshot. Safe to call from any thread.
+  RobotStateSnapshot read();
+
+  // Returns the number of times a reader had to copy the snapshot again because it was overwritten.
+  int getSnapshotRetries();
+  // Resets the retry counter.
+  void resetCounters();
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include "vex.h"
+
+// A feedforward model of the drivetrain measured by system identification.
+struct DriveModel
+{
+  // Identifies a model written by this version of the fit.
+  uint32_t magic;
+  // Driving straight: volts to overcome static friction, volts per inch/sec and volts per inch/sec^2.
+  float driveKs;
+  float driveKv;
+  float driveKa;
+  // Turning in place: volts, volts per deg/sec and volts per deg/sec^2. turnKa over driveKa is
+  // the robot's rotational inertia relative to its mass.
+  float turnKs;
+  float turnKv;
+  float turnKa;
+  // The effective track width in inches, from the wheel speeds against the gyro rate while turning.
+  float trackWidth;
+  // The number of samples in each fit.
+  int driveSamples;
+  int turnSamples;
+  uint32_t checksum;
+};
+
+// The sums of a least squares fit of volts = kS * sign(velocity) + kV * velocity + kA * acceleration.
+struct FeedforwardFit
+{
+  double xx[3][3];
+  double xy[3];
+  int count;
+};
+
+// A sample of a characterization test.
+struct SystemIdSample
+{
+  float time;
+  float voltage;
+  float leftPosition;
+  float rightPosition;
+  // The heading unwrapped across 0/360.
+  float heading;
+};
+
+// A class to measure the drivetrain's feedforward constants and track width on the robot.
+// It runs quasistatic voltage ramps and dynamic voltage steps, driving straight and turning in place,
+// sampling every 5 msec. Velocities and accelerations are taken as central differences of the encoder
+// and gyro readings, and the constants are fit by least squares as the samples arrive, so no log is kept.
+// The model is saved to the SD card and applied on top of the chassis defaults on every start.
+class SystemId
+{
+private:
+  // The measured model, and whether it is valid.
+  DriveModel model;
+  bool modelValid = false;
+
+  // The ramp rate in volts/sec of the quasistatic tests and the voltage of the dynamic tests.
+  float rampRate = 1;
+  float stepVoltage = 6;
+  // The straight tests stop after this many inches, the turn tests after this many degrees.
+  float maxDistance = 48;
+  float maxAngle = 720;
+
+  // The fits and the sums of the track width fit.
+  FeedforwardFit driveFit;
+  FeedforwardFit turnFit;
+  double trackWheelRate = 0;
+  double trackGyroRate = 0;
+
+  // The last samples of the running test, for the central differences. The differences span
+  // SPACING samples, 80 msec, so the encoder resolution does not swamp the acceleration.
+  static const int SPACING = 16;
+  static const int HISTORY = 2 * SPACING + 1;
+  SystemIdSample history[HISTORY];
+  int historyCount = 0;
+
+  // Runs one test: a ramp if quasistatic, else a step. direction is 1 or -1.
+  void runTest(bool turning, bool quasistatic, int direction);
+  // Adds a sample to the history and the fits.
+  void addSample(bool turning, const SystemIdSample& sample);
+  // Adds a point to a fit.
+  void addToFit(FeedforwardFit& fit, float voltage, float velocity, float acceleration);
+  // Solves a fit. Returns false if the samples do not determine the constants.
+  bool solve(const FeedforwardFit& fit, float& kS, float& kV, float& kA);
+  // Returns the checksum of a model.
+  uint32_t checksum(const DriveModel& model);
+
+public:
+  // The constructor for the SystemId class.
+  SystemId();
+
+  // Runs all the tests, fits the model and saves it. The robot needs about 4 feet of room in front
+  // and room to spin. Returns false if the run was cancelled or the fit failed.
+  bool run();
+  // Reads the model from the SD card. Returns false if there is no valid model.
+  bool load();
+  // Writes the model to the SD card. Returns false if it could not be written.
+  bool save();
+  // Applies the measured constants to the chassis, if there is a model.
+  void apply();
+  // Returns the model, or nullptr if there is none.
+  const DriveModel* getModel();
+  // Shows the model on the controller.
+  void printModel();
+};
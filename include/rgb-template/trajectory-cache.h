@@ -0,0 +1,96 @@
+#pragma once
+#include "vex.h"
+#include <atomic>
+
+// A motion profile stored in the trajectory cache.
+struct TrajectoryEntry
+{
+  ProfileSpec spec;
+  // The index of the first sample in the arena, and the number of samples.
+  int offset;
+  int sampleCount;
+};
+
+// The contents of the trajectory cache. It is one contiguous block, so it is saved to and loaded
+// from the SD card as is.
+struct TrajectoryStore
+{
+  static const int MAX_ENTRIES = 48;
+  // 6000 samples hold 60 sec of motion, 48 KB.
+  static const int MAX_SAMPLES = 6000;
+
+  // Identifies a store written by this version of the profile generator.
+  uint32_t magic;
+  // The hash of the specs the store was built from.
+  uint32_t contentHash;
+  int entryCount;
+  int sampleCount;
+  TrajectoryEntry entries[MAX_ENTRIES];
+  ProfileSample samples[MAX_SAMPLES];
+};
+
+// A class to build the motion profiles of an autonomous routine before the match, so the motion
+// functions replay them instead of computing them when the auton starts.
+// precompute() builds the profiles on a background thread. The profiles are saved to the SD card
+// in a file named by the hash of their specs, so after a reboot the same set is loaded, not rebuilt.
+class TrajectoryCache
+{
+private:
+  // The cached profiles.
+  TrajectoryStore store;
+  // Held while the store is built or changed.
+  vex::mutex cacheLock;
+
+  // The specs to build on the background thread.
+  const ProfileSpec* pendingSpecs = nullptr;
+  int pendingCount = 0;
+  uint32_t pendingHash = 0;
+  // True while the background thread is building.
+  std::atomic<bool> building;
+  // The number of motions following profiles from the store. The store is not rebuilt until it is 0.
+  int activeUsers = 0;
+
+  // Statistics.
+  int hits = 0;
+  int misses = 0;
+  bool loadedFromSD = false;
+  // The time the last build took in usec.
+  uint32_t buildTime = 0;
+
+  // The background task that builds the pending specs.
+  static int buildTask(void* cache);
+  // Builds the pending specs, or loads them from the SD card.
+  void build();
+  // Appends a profile to the store. Call with cacheLock held.
+  const ProfileSample* append(const ProfileSpec& spec, int& sampleCount);
+  // Returns the hash of a list of specs.
+  static uint32_t hashSpecs(const ProfileSpec* specs, int count);
+  // Writes the SD card file name for a content hash.
+  static void fileName(uint32_t contentHash, char* name, int size);
+
+public:
+  // The constructor for the TrajectoryCache class.
+  TrajectoryCache();
+
+  // Starts building the profiles of a routine on a background thread. Returns immediately, and does
+  // nothing if the profiles of the same specs are already built or being built.
+  void precompute(const ProfileSpec* specs, int count);
+  // Returns true once the last precompute() has finished.
+  bool isReady();
+
+  // Returns the samples of a profile, building and caching it first if it was not precomputed.
+  // Returns nullptr if the cache is full. The samples stay valid until release() is called.
+  const ProfileSample* get(const ProfileSpec& spec, int& sampleCount);
+  // Tells the cache a motion is done with the samples from get(), so the store can be rebuilt.
+  void release();
+
+  // Returns the number of profiles found in the cache and the number built on demand.
+  int getHits();
+  int getMisses();
+  // Returns true if the last precompute() loaded the profiles from the SD card.
+  bool wasLoadedFromSD();
+  // Returns the time the last precompute() took in usec.
+  uint32_t getBuildTime();
+  // Returns the hash of the specs of the last precompute().
+  uint32_t getContentHash();
+};
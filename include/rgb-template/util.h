@@ -17,10 +17,11 @@ float toVolt(float percent);
 // Creates a dead zone for a joystick axis.
 float deadband(float input, float width);
 
-// Checks if all motors are connected and not overheating.
-bool checkMotors(int motorCount, int temperatureLimit = 50);
+// Queues a message for the controller screen with right-padding to 24 characters. Returns immediately.
+// holdTime is how long in msec the message stays up before a message of the same or lower priority replaces it.
+void printControllerScreen(const char* message, messagePriority priority = MESSAGE_NORMAL, uint32_t holdTime = 0);
 
-// Prints a message to the controller screen with right-padding to 20 characters.
-void printControllerScreen(const char* message);
+// Queues a rumble pattern for the controller. Returns immediately.
+void rumbleController(const char* pattern);
 
 
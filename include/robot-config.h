@@ -1,14 +1,32 @@
 using namespace vex;
 
 extern motor rollerBottom;
-extern motor rollerMiddle;
 extern motor rollerTop;
+// Forward declaration of the ActuatorRegistry class.
+class ActuatorRegistry;
+// the registry of subsystem motors
+extern ActuatorRegistry actuators;
 
 // optical sensor for team color detection
 extern optical teamOptical;
-extern bool teamIsRed;
 // distance sensor at the front
 extern distance frontDistance;
+// the front distance in inches, or 0 if the sensor is not installed. Autons and macros read it through this,
+// so it is logged with their motion and read back from the log when the motion is replayed.
+float getFrontDistance();
+// rotation sensor dial for selecting the auton
+extern rotation autonDial;
+
+// optical sensor that sees game objects entering the rollers
+extern optical sortOptical;
+// Forward declaration of the Intake class.
+class Intake;
+// the intake rollers, run as a state machine with jam recovery
+extern Intake intakeRollers;
+// Forward declaration of the ColorSort class.
+class ColorSort;
+// sorts opponent game objects out of the rollers
+extern ColorSort colorSort;
 
 bool toggleMatchLoad();
 bool toggleHorn();
@@ -16,6 +34,7 @@ void intake();
 void outTake();
 void stopRollers();
 void scoreLong();
+void startMatchLoadMacro();
 
 
 // ------------------------------------------------------------------------
@@ -29,9 +48,48 @@ extern controller controller1;
 class Drive;
 // A global instance of the Drive class.
 extern Drive chassis;
-extern int DRIVE_MODE;
+// Forward declaration of the MacroRunner class.
+class MacroRunner;
+// A global instance of the MacroRunner class.
+extern MacroRunner macroRunner;
+extern const int DRIVE_MODE;
+// Forward declaration of the RobotState class.
+class RobotState;
+// A global instance of the state shared between threads.
+extern RobotState robotState;
+// Forward declaration of the ChassisArbiter class.
+class ChassisArbiter;
+// A global instance of the arbiter that decides which source drives the chassis.
+extern ChassisArbiter chassisArbiter;
 
-extern const int NUMBER_OF_MOTORS;
+// Forward declaration of the ControllerOutput class.
+class ControllerOutput;
+// A global instance of the queue for controller screen messages and rumbles.
+extern ControllerOutput controllerOutput;
+// Forward declaration of the TrajectoryCache class.
+class TrajectoryCache;
+// A global instance of the cache of precomputed motion profiles.
+extern TrajectoryCache trajectoryCache;
+// Forward declaration of the MotionLog class.
+class MotionLog;
+// A global instance of the recorder that logs and replays the drivetrain's sensor readings and commands.
+extern MotionLog motionLog;
+// Forward declaration of the SystemId class.
+class SystemId;
+// A global instance of the drivetrain characterization and its measured model.
+extern SystemId systemId;
+// Forward declaration of the Dashboard class.
+class Dashboard;
+// A global instance of the live data display on the brain screen.
+extern Dashboard dashboard;
+// Forward declaration of the AutonSelector class.
+class AutonSelector;
+// A global instance of the auton selector.
+extern AutonSelector autonSelector;
+// Forward declaration of the DriveModes class.
+class DriveModes;
+// A global instance of the table of driver control modes.
+extern DriveModes driveModes;
 
 void changeDriveMode();
 void setChassisDefaults();
@@ -19,10 +19,29 @@
 
 #include "robot-config.h"
 #include "autons.h"
+#include "rgb-template/actuators.h"
+#include "color-sort.h"
+#include "intake.h"
 
+#include "rgb-template/control-math.h"
+#include "rgb-template/robot-state.h"
+#include "rgb-template/chassis-arbiter.h"
+#include "rgb-template/motion-profile.h"
+#include "rgb-template/trajectory-cache.h"
+#include "rgb-template/motion-log.h"
 #include "rgb-template/drive.h"
+#include "rgb-template/drive-modes.h"
+#include "rgb-template/controller-output.h"
 #include "rgb-template/util.h"
 #include "rgb-template/PID.h"
+#include "rgb-template/macro.h"
+#include "rgb-template/loop-timer.h"
+#include "rgb-template/latency-stats.h"
+#include "rgb-template/system-id.h"
+#include "rgb-template/match-scheduler.h"
+#include "rgb-template/drive-simulation.h"
+#include "rgb-template/dashboard.h"
+#include "rgb-template/auton-selector.h"
 
 #define waitUntil(condition)                                                   \
   do {                                                                         \
@@ -1,6 +1,4 @@
 #include "vex.h"
-int currentAutonSelection = -1;        // Current auton selection
-int autonTestStep = 0;                // Current step in auton
 
 void quick_test() {
   //awp();
@@ -8,13 +6,13 @@ void quick_test() {
   /*
   chassis.setHeading(180);
   chassis.turnToHeading(90, 10, 4);
-  float d = frontDistance.objectDistance(inches);
+  float d = getFrontDistance();
   chassis.driveDistance(d - 14); */
 
   /*
   chassis.setHeading(180);
   chassis.driveDistance(32, 10, 90, 6, 3);
-  float d = frontDistance.objectDistance(inches);
+  float d = getFrontDistance();
   chassis.driveDistance(d - 14); 
   */
 }
@@ -22,43 +20,59 @@ void quick_test() {
 // The first autonomous routine.
 void sampleAuton1() {
   chassis.driveWithVoltage(3, 3);
-  wait(1000, msec);
+  chassis.waitTime(1000);
   chassis.stop(brake);
 }
 
+// The motion profiles of the second autonomous routine: distance, max velocity, acceleration,
+// start velocity and end velocity. They are built when the routine is selected.
+ProfileSpec sampleAuton2Profiles[] = {
+  {-12, 30, 60, 0, 0},
+  {12, 30, 60, 0, 0},
+};
+
 // The second autonomous routine.
 void sampleAuton2() {
   chassis.setHeading(180); // place the robot backwards
-  chassis.driveDistance(-12, 6);
+  chassis.driveProfile(sampleAuton2Profiles[0], 6);
   chassis.turnToHeading(0, 6);
-  chassis.driveDistance(12, 6);
+  chassis.driveProfile(sampleAuton2Profiles[1], 6);
 }
 
 // A long autonomous routine, e.g. skill.
 // This routine is broken into steps to allow for testing of individual steps.
 // This allows for easier debugging of individual parts of the long autonomous routine.
 void sampleSkill() {
-  if (autonTestStep == 0) 
+  if (robotState.autonTestStep == 0) 
   {
     chassis.turnToHeading(180);
     if (!continueAutonStep()) return; // If in test mode, stop here for testing.
   }
-  if (autonTestStep == 1)  
+  if (robotState.autonTestStep == 1)  
   {
-    chassis.driveDistance(5);
-    chassis.turnToHeading(chassis.getHeading() + 90); // Turn right
+    // Drives forward and turns right as one chained motion, so the turn starts without settling the drive.
+    float heading = chassis.getHeading();
+    ChainSegment driveAndTurn[] = {
+      {CHAIN_DRIVE, 5, heading, 30, 60},
+      {CHAIN_TURN, heading + 90}
+    };
+    chassis.driveChain(driveAndTurn, 2);
     if (!continueAutonStep()) return; // If in test mode, stop here for testing.
   } 
-  if(autonTestStep == 2) 
+  if(robotState.autonTestStep == 2) 
   {
     chassis.turnToHeading(chassis.getHeading() - 90); // Turn left
     chassis.driveDistance(-5);
   }
 }
 
+// The plant the benchmark runs on. It is fixed, so the results only change when the motion code does;
+// copy the constants from a sysid run to match the robot, then save a new baseline.
+const DriveModel benchmarkModel = {0, 0.6, 0.185, 0.03, 1.0, 0.0194, 0.0023, 12, 0, 0, 0};
+
 // Runs the selected autonomous routine.
 void runAutonItem() {
-  switch (currentAutonSelection) {
+  switch (robotState.autonSelection) {
   case 0:
     sampleAuton1();
     break;
@@ -74,6 +88,63 @@ void runAutonItem() {
   }
 }
 
+// Builds what an auton needs before it runs, without touching the chassis settings or heading.
+void precomputeAutonItem(int selection) {
+  switch (selection) {
+  case 1:
+    trajectoryCache.precompute(sampleAuton2Profiles, sizeof(sampleAuton2Profiles) / sizeof(sampleAuton2Profiles[0]));
+    break;
+  }
+}
+
+// Prepares the selected autonomous routine before the match, so autonomous() starts moving right away.
+// Runs whenever the selection changes in pre-auton, and before each run in test mode.
+void prepareAutonItem() {
+  setChassisDefaults();
+  // Replaces the estimated feedforward constants and track width with the measured ones,
+  // once the sysid routine has been run and saved a model to the SD card.
+  systemId.apply();
+  precomputeAutonItem(robotState.autonSelection);
+}
+
+// Runs a tool from the test mode menu.
+void runTestTool(int tool) {
+  switch (tool) {
+  case 0:
+    replayMotionLog();
+    break;
+  case 1:
+    // Measures the drivetrain's feedforward constants and track width. Needs 4 feet of room in front.
+    systemId.run();
+    break;
+  }
+}
+
+void replayMotionLog() {
+  if (!motionLog.load("motion.bin") || motionLog.getAutonSelection() == robotState.autonSelection) {
+    printControllerScreen("no motion log", MESSAGE_HIGH, 2000);
+    return;
+  }
+  // Runs the logged auton with the current settings. The drivetrain reads its sensors from the log,
+  // so the motors stay still and the motion functions run without waiting between ticks.
+  int selection = robotState.autonSelection;
+  robotState.autonSelection = motionLog.getAutonSelection();
+  prepareAutonItem();
+  float startTime = timer::system();
+  motionLog.startReplay();
+  runAutonItem();
+  motionLog.stopReplay();
+  float replayTime = timer::system() - startTime;
+  robotState.drivetrainNeedsStopped = false;
+  robotState.autonSelection = selection;
+  prepareAutonItem();
+
+  char msg[30];
+  sprintf(msg, "%.1fs log in %.0fms", motionLog.getSampleCount() * 0.01, replayTime);
+  printControllerScreen(msg, MESSAGE_NORMAL, 2000);
+  motionLog.printReport();
+}
+
 // The names of the autonomous routines to be displayed in the menu.
 char const * autonMenuText[] = {
   "auton1",
@@ -81,13 +152,22 @@ char const * autonMenuText[] = {
   "auton_skill"
 };
 
+// The names of the tools run by runTestTool(). They follow the autonomous routines in the menu in
+// test mode only, so neither the dial nor a saved selection can run one in a match.
+char const * testToolText[] = {
+  "log_replay",
+  "sysid"
+};
+
 
 
 // ----------------------------------------------------------------------------
 //                 Only change code below this line when necessary
 // ----------------------------------------------------------------------------
 
-int autonNum;                         // Total number of autons, automatically calculated based on the size of the autonMenuText array
+// Total number of autons and test tools, automatically calculated based on the size of the autonMenuText and testToolText arrays
+int autonNum = sizeof(autonMenuText) / sizeof(autonMenuText[0]);
+int testToolNum = sizeof(testToolText) / sizeof(testToolText[0]);
 bool autonTestMode = false;           // Indicates if in test mode
 bool configMode = false;              // Indicates if in configuration mode
 bool exitAutonMenu = false;           // Flag to exit the autonomous menu
@@ -100,81 +180,109 @@ void autonomous(void) {
   exitAutonMenu = true;
   enableEndGameTimer = true;
   // Runs the selected autonomous routine.
+  chassisArbiter.bindThread(OWNER_AUTON);
+  chassisArbiter.claim(OWNER_AUTON);
+  // Logs the drivetrain's sensor readings and commands, so the run can be replayed after the match.
+  // Field control kills this task when autonomous ends, so exitAuton() saves the log.
+  motionLog.startRecording(robotState.autonSelection);
   runAutonItem();
+  chassisArbiter.release(OWNER_AUTON);
+  chassisArbiter.unbindThread();
+}
+
+// Returns the number of menu items: the autonomous routines, and the tools as well in test mode.
+int menuSize() {
+  return autonTestMode ? autonNum + testToolNum : autonNum;
+}
+
+// Returns the name of a menu item.
+const char* menuItemName(int selection) {
+  if (selection >= autonNum) return testToolText[selection - autonNum];
+  return autonMenuText[selection];
 }
 
 // This function prints the selected autonomous routine to the brain and controller screens.
 void printMenuItem() {
-  if (currentAutonSelection < 0) {
+  if (robotState.autonSelection < 0) {
     printControllerScreen("quick test");
     return;
   }    
-  // Clears the brain screen.
-  Brain.Screen.clearScreen();
-  // Sets the cursor to the third row, first column.
-  Brain.Screen.setCursor(3, 1);
-  // Prints the selected autonomous routine name.
-  Brain.Screen.print("%s", autonMenuText[currentAutonSelection]);
-  printControllerScreen(autonMenuText[currentAutonSelection]);
+  // The dashboard shows the selection on the brain screen in its next frame.
+  printControllerScreen(menuItemName(robotState.autonSelection));
+}
+
+void formatAutonSelection(char* text, int size) {
+  int selection = robotState.autonSelection;
+  snprintf(text, size, "%s", selection < 0 ? "quick test" : menuItemName(selection));
 }
 
 // This function displays the autonomous menu on the brain screen.
 void showAutonMenu() {
-  autonNum = sizeof(autonMenuText) / sizeof(autonMenuText[0]);
-  autonTestStep = 0;
+  robotState.autonTestStep = 0;
 
-  Brain.Screen.setFont(mono30);
   printMenuItem();
 
   // This loop runs until the autonomous menu is exited.
   while (!exitAutonMenu) {
+    int selection = robotState.autonSelection;
     // If the brain screen is pressed, cycle through the autonomous routines.
     if (Brain.Screen.pressing()) {
       // Waits until the finger is lifted up from the screen.
       while (Brain.Screen.pressing()) {
         wait(20, msec);
       }
-      // Cycles through the autonomous routines.
-      currentAutonSelection = (currentAutonSelection + 1) % autonNum;
+      selection = (selection + 1) % menuSize();
+    }
+    // The dial and the controller jump straight to an auton.
+    selection = autonSelector.poll(selection, autonNum);
+    if (selection != robotState.autonSelection) {
+      robotState.autonSelection = selection;
       printMenuItem();
-      controller1.rumble(".");
+      rumbleController(".");
+      prepareAutonItem();
+      // Only the autonomous routines are kept for the next start.
+      if (selection < autonNum) autonSelector.scheduleSave();
     }
+    autonSelector.saveIfDue();
     // This wait prevents the loop from using too much CPU time.
-    wait(50, msec);
+    wait(20, msec);
   }
-  Brain.Screen.setFont(mono20);
+  // Keeps a selection made just before the match started.
+  autonSelector.saveIfDue();
 }
 
-// This function is a thread that runs in the background to remind the driver of the end game.
-void endgameTimer() {
-  // Waits until the end game starts.
-  while (Brain.Timer.time(sec) < END_GAME_SECONDS) {
-    wait(500, msec);
-  }
+// Reminds the driver that the end game has started.
+void endgameWarning() {
   if (enableEndGameTimer)
   {
-    printControllerScreen("end game");
-    controller1.rumble("-");
+    printControllerScreen("end game", MESSAGE_HIGH, 2000);
+    rumbleController("-");
   }
+}
 
-  // Checks the motors health every 60 seconds in drive practice
-  while(true)
-  {
-    wait(60, seconds);
-    if (!autonTestMode) checkMotors(NUMBER_OF_MOTORS);
-  }
+// Checks the motors health in drive practice.
+void checkMotorHealth() {
+  if (!autonTestMode) actuators.checkHealth();
 }
 
 void exitAuton()
 {
+  // Field control kills the autonomous task without letting it release the drivetrain, so its claim is dropped here.
+  chassisArbiter.reset();
+  // Saves the log of the autonomous period for log_replay.
+  if (motionLog.isRecording()) {
+    motionLog.stopRecording();
+    motionLog.save("motion.bin");
+  }
   exitAutonMenu = true;
-  chassis.joystickTouched = false;
+  robotState.joystickTouched = false;
     // Clears the brain timer.
   Brain.Timer.clear();
-    // Starts the end game timer thread.
-  thread endgameTimer_thread = thread(endgameTimer);
-  if (!chassis.joystickTouched) {
-    //TODO: some macto actions
+    // Starts the match clock for the end game warning and motor health checks.
+  MatchScheduler::instance().start();
+  if (!robotState.joystickTouched) {
+    // Start a macro here with macroRunner.start() to act right at the start of driver control.
+    // It is cancelled as soon as the driver touches a joystick.
   }
   chassis.stop(coast);
 }
@@ -182,9 +290,8 @@ void exitAuton()
 bool setupgyro() {
   wait(100, msec);
   if (!chassis.gyro.installed()) {
-    printControllerScreen("inertial sensor failure");
-    controller1.rumble("---");
-    wait(2, seconds);
+    printControllerScreen("inertial sensor failure", MESSAGE_HIGH, 2000);
+    rumbleController("---");
     return false;  
   }
 
@@ -194,7 +301,7 @@ bool setupgyro() {
     wait(100, msec);
   }
   // Rumbles the controller to indicate that the gyro is calibrated.
-  controller1.rumble(".");
+  rumbleController(".");
   return true;
 }
 
@@ -202,125 +309,65 @@ void setupTeamColor(){
   if (teamOptical.installed()) {
     // Sets the team color based on the optical sensor.
     if (teamOptical.color() == color::blue) {
-      teamIsRed = false;
-      printControllerScreen("team blue");
+      robotState.teamIsRed = false;
+      printControllerScreen("team blue", MESSAGE_NORMAL, 1000);
     } else {
-      printControllerScreen("team red");
+      printControllerScreen("team red", MESSAGE_NORMAL, 1000);
     }
-    wait(1, seconds);
   } 
 }
 
 
-/**
- * @brief Trim leading and trailing whitespace from a string.
- * @param str The string to trim.
- * @return A pointer to the trimmed string.
- */
-char* trim_whitespace(char* str) {
-    char* end;
-    // Trim leading whitespace
-    while (isspace((unsigned char)*str)) {
-        str++;
-    }
-    if (*str == 0) {
-        return str; // All whitespace
-    }
-    // Trim trailing whitespace
-    end = str + strlen(str) - 1;
-    while (end > str && isspace((unsigned char)*end)) {
-        end--;
-    }
-    *(end + 1) = 0;
-    return str;
-}
-
 void loadConfigParameters()
 {
-  // load parameters from the SD card
-  if (Brain.SDcard.isInserted()) {
-    if (Brain.SDcard.exists("parameters.txt")) {
-      printControllerScreen("load param from SD");
-    } 
-    // open the file for reading
-    uint8_t  myReadBuffer[1000];  
-    int32_t  size = Brain.SDcard.loadfile("parameters.txt", myReadBuffer, sizeof(myReadBuffer));
-    wait(0.5, seconds);
-
-    char line_buffer[256];
-    char* buffer_ptr = (char*)myReadBuffer;
-    char* line_end;
-
-    // Process the buffer line by line
-    while ((line_end = strchr(buffer_ptr, '\n')) != NULL) {
-        // Copy the current line into the line_buffer
-        int line_len = line_end - buffer_ptr;
-        strncpy(line_buffer, buffer_ptr, line_len);
-        line_buffer[line_len] = '\0';
-
-        // Find the position of the '=' character
-        char* equals_sign = strchr(line_buffer, '=');
-        if (equals_sign != NULL) {
-            // Null-terminate the key part of the string
-            *equals_sign = '\0';
-            
-            // Extract the key and value strings
-            char* key = trim_whitespace(line_buffer);
-            char* value_str = trim_whitespace(equals_sign + 1);
-
-            // Check if the line is for 'auton' and 'drive_mode'
-            if (strcmp(key, "auton") == 0) {
-                currentAutonSelection = atoi(value_str);
-            } else if (strcmp(key, "drive_mode") == 0) {
-                DRIVE_MODE = atoi(value_str);
-            }
-        }
-        
-        // Move the pointer to the start of the next line
-        buffer_ptr = line_end + 1;
-    }
-
+  // load the auton selection and drive mode from the SD card
+  if (autonSelector.load(autonNum, driveModes.getCount())) {
+    printControllerScreen("load param from SD");
   }
+  // load the measured drivetrain model, applied on top of the chassis defaults
+  systemId.load();
 }
 
 void saveConfigParameters()
 {
-  // save parameters to the SD card
+  // save the auton selection and drive mode to the SD card
   if (Brain.SDcard.isInserted()) {
-    printControllerScreen("save param to SD");
-    
-    // Create the parameter string with current values
-    char parameter_buffer[256];
-    sprintf(parameter_buffer, "auton = %d\ndrive_mode = %d\n", currentAutonSelection, DRIVE_MODE);
-    
-    // Save the parameters to the SD card
-    int32_t result = Brain.SDcard.savefile("parameters.txt", (uint8_t*)parameter_buffer, strlen(parameter_buffer));
-    
-    if (result > 0) {
-      printControllerScreen("param saved");
+    if (autonSelector.save()) {
+      printControllerScreen("param saved", MESSAGE_NORMAL, 1000);
     } else {
-      printControllerScreen("save failed");
+      printControllerScreen("save failed", MESSAGE_HIGH, 1000);
     }
-    wait(1, seconds);
-
   } 
 }
 
 // This function is called before the autonomous period starts.
 void pre_auton() {
+  // Starts sending queued messages and rumbles to the controller.
+  controllerOutput.start();
   // Sets up the gyro.
   bool gyroSetupSuccess = setupgyro();
   // Sets up the team color.
   setupTeamColor();
+  // Starts sending subsystem motor commands, the intake state machine and sorting opponent game objects out of the rollers.
+  actuators.start();
+  intakeRollers.start();
+  colorSort.start();
+  // Starts showing live robot data on the brain screen.
+  dashboard.start();
+  // Schedules the end game warning and a motor health check every 60 seconds from the start of driver control.
+  MatchScheduler::instance().schedule(END_GAME_SECONDS * 1000, endgameWarning);
+  MatchScheduler::instance().schedule(60000, checkMotorHealth, 60000);
 
   bool motorsSetupSuccess = true;
-  // Checks the motors.
-  motorsSetupSuccess = checkMotors(NUMBER_OF_MOTORS);
+  // Checks the registered motors.
+  motorsSetupSuccess = actuators.checkHealth();
   //set the parameters for the chassis
   setChassisDefaults();
 
   // load parameters from the SD card
   loadConfigParameters();
+  // Sets up the selected auton now, so nothing is left to do when autonomous starts.
+  prepareAutonItem();
   // Shows the autonomous menu.
   if(gyroSetupSuccess && motorsSetupSuccess) showAutonMenu();
 }
@@ -333,34 +380,53 @@ void pre_auton() {
 
 bool continueAutonStep()
 {
-  autonTestStep++;
+  robotState.autonTestStep++;
   if (autonTestMode) return false; // If in test mode, stop here for testing.
   return true; 
 }
 
+void runBenchmarkAuton(int selection) {
+  int current = robotState.autonSelection;
+  int testStep = robotState.autonTestStep;
+  bool testMode = autonTestMode;
+  robotState.autonSelection = selection;
+  robotState.autonTestStep = 0;
+  // Runs every step of a long routine, not just the one being tested.
+  autonTestMode = false;
+  // Keeps the caller's constants and the simulated heading, so the gyro and the measured model stay out of the run.
+  precomputeAutonItem(selection);
+  runAutonItem();
+  autonTestMode = testMode;
+  robotState.autonTestStep = testStep;
+  robotState.autonSelection = current;
+}
+
 // This function is called when the Right button is pressed.
 void buttonRightAction()
 {
+  // B and a D-pad direction select an auton instead.
+  if (autonSelector.isChordHeld()) return;
   if ((Brain.Timer.time(sec) < 5) && !autonTestMode) {  
     // If the button is pressed within 5 seconds of starting the program, enter test mode.
-    controller1.rumble("-");
-    printControllerScreen("Test Mode: ON");
-    wait(1, sec);
+    rumbleController("-");
+    printControllerScreen("Test Mode: ON", MESSAGE_NORMAL, 1000);
     showAutonMenu();
     autonTestMode = true;
     return;
   } 
   if (autonTestMode)
   {
-    controller1.rumble(".");
+    rumbleController(".");
     // if in test mode, scroll through the auton menu
-    currentAutonSelection = (currentAutonSelection + 1) % autonNum;
+    robotState.autonSelection = (robotState.autonSelection + 1) % menuSize();
     showAutonMenu();
   }
 }
 
 void buttonLeftAction()
 {
+  // B and a D-pad direction select an auton instead.
+  if (autonSelector.isChordHeld()) return;
   if ((Brain.Timer.time(sec) < 5 && !configMode)) {
     // If the button is pressed within 5 seconds of starting the program, change the drive mode.
     changeDriveMode();
@@ -374,69 +440,68 @@ void buttonLeftAction()
   if (autonTestMode) 
   {
     // if in test mode, scroll through the auton menu
-    controller1.rumble(".");
-    currentAutonSelection = (currentAutonSelection - 1 + autonNum) % autonNum;
+    rumbleController(".");
+    robotState.autonSelection = (robotState.autonSelection - 1 + menuSize()) % menuSize();
     showAutonMenu();
     return;
   }
 }
 
-bool macroMode = false;
-
 void buttonDownAction()
 {
+  // B and a D-pad direction select an auton instead.
+  if (autonSelector.isChordHeld()) return;
   if (autonTestMode) 
   {
     // If in test mode, go to the next step.
-    controller1.rumble(".");
-    autonTestStep++;
+    rumbleController(".");
+    robotState.autonTestStep++;
     char msg[30];
-    sprintf(msg, "Step: %d", autonTestStep);
+    sprintf(msg, "Step: %d", robotState.autonTestStep.load());
     printControllerScreen(msg);
+    return;
   }
 
-  if (macroMode) return; // prevent re-entry
-  if (fabs(chassis.getHeading()) - 180 > 3) {
-    chassis.driveWithVoltage(-6, -6);
-    wait(100, msec);
-    chassis.turnToHeading(180);
-  }
-  if (!controller1.ButtonDown.pressing()) return;
-  
-  macroMode = true;
-  // This is a placeholder for future actions triggered by Button Down.
-  // safty check to prevent running the code if the distance reading is not valid.
-  // Matchload balls when the Button Down is pressed and hold.
-  // end matchloading and turn around to score when the Button Down is released.
-  macroMode = false;
-  chassis.stop(coast);
+  // Runs the match load macro. Touching a joystick cancels it.
+  startMatchLoadMacro();
 }
 
 void buttonUpAction()
 {
+  // B and a D-pad direction select an auton instead.
+  if (autonSelector.isChordHeld()) return;
   if (autonTestMode) 
   {
     // If in test mode, go to the previous step.
-    controller1.rumble(".");
-    if (autonTestStep > 0) autonTestStep--;
+    rumbleController(".");
+    if (robotState.autonTestStep > 0) robotState.autonTestStep--;
     char msg[30];
-    sprintf(msg, "Step: %d", autonTestStep);
+    sprintf(msg, "Step: %d", robotState.autonTestStep.load());
     printControllerScreen(msg);
   }
 }
 
 void buttonAAction()
 {
-  if (autonTestMode || configMode) 
+  if ((autonTestMode || configMode) && robotState.autonSelection < autonNum) 
   {
     saveConfigParameters();
   }
   if (autonTestMode) 
   {
     // If in test mode, run the selected autonomous routine for testing and displays the run time.
-    controller(primary).rumble(".");
+    rumbleController(".");
+    prepareAutonItem();
     double t1 = Brain.Timer.time(sec);
-    runAutonItem(); 
+    chassisArbiter.bindThread(OWNER_AUTON);
+    chassisArbiter.claim(OWNER_AUTON);
+    if (robotState.autonSelection >= autonNum) {
+      runTestTool(robotState.autonSelection - autonNum);
+    } else {
+      runAutonItem();
+    }
+    chassisArbiter.release(OWNER_AUTON);
+    chassisArbiter.unbindThread();
     double t2 = Brain.Timer.time(sec);
     char timeMsg[30];
     sprintf(timeMsg, "run time: %.1f", t2-t1);
@@ -446,7 +511,6 @@ void buttonAAction()
 }
 
 
-
 // Register the controller button callbacks for autonomous testing.
 void registerAutonTestButtons()
 {
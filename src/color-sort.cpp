@@ -0,0 +1,124 @@
+#include "vex.h"
+
+ColorSort::ColorSort(optical& sensor, motor& roller, void (*ejectAction)(bool eject)) :
+  sensor(sensor),
+  roller(roller),
+  ejectAction(ejectAction) {}
+
+void ColorSort::start() {
+  if (!sensor.installed()) return;
+  // Run the LED at full power so the hue reading does not depend on field lighting,
+  // and shorten the integration time so the sensor updates as fast as it can.
+  sensor.setLight(ledState::on);
+  sensor.setLightPower(100, percent);
+  sensor.integrationTime(5);
+  thread sortThread = thread(sortTask, this);
+}
+
+int ColorSort::sortTask(void* colorSort) {
+  ColorSort* sorter = static_cast<ColorSort*>(colorSort);
+  while (true) {
+    sorter->update();
+    wait(5, msec);
+  }
+  return 0;
+}
+
+void ColorSort::setEnabled(bool enabled) {
+  this -> enabled = enabled;
+  if (!enabled) pendingEjectCount = 0;
+}
+
+bool ColorSort::isEnabled() {
+  return enabled;
+}
+
+bool ColorSort::isEjecting() {
+  return ejecting;
+}
+
+void ColorSort::setHueRanges(float redHueMin, float redHueMax, float blueHueMin, float blueHueMax) {
+  this -> redHueMin = redHueMin;
+  this -> redHueMax = redHueMax;
+  this -> blueHueMin = blueHueMin;
+  this -> blueHueMax = blueHueMax;
+}
+
+void ColorSort::setEjectTiming(float ejectTravelDeg, float ejectLatency, float ejectTime) {
+  this -> ejectTravelDeg = ejectTravelDeg;
+  this -> ejectLatency = ejectLatency;
+  this -> ejectTime = ejectTime;
+}
+
+objectColor ColorSort::classify() {
+  if (!sensor.isNearObject()) return OBJECT_NONE;
+  float hue = sensor.hue();
+  if (hue >= redHueMin || hue <= redHueMax) return OBJECT_RED;
+  if (hue >= blueHueMin && hue <= blueHueMax) return OBJECT_BLUE;
+  return OBJECT_NONE;
+}
+
+void ColorSort::update() {
+  float now = timer::system();
+  if (ejecting && now >= ejectEndTime) {
+    ejecting = false;
+    ejectAction(false);
+  }
+  if (!enabled) return;
+
+  float rollerPosition = roller.position(deg);
+  float rollerVelocity = roller.velocity(dps);
+  // Objects leave through the intake when the rollers run backwards.
+  if (rollerVelocity < 0) pendingEjectCount = 0;
+
+  objectColor seen = classify();
+  if (seen == OBJECT_NONE) {
+    objectPresent = false;
+  } else if (!objectPresent) {
+    objectPresent = true;
+    if (objectsSeen == 0) firstObjectTime = now;
+    lastObjectTime = now;
+    objectsSeen++;
+    bool isOpponent = robotState.teamIsRed ? (seen == OBJECT_BLUE) : (seen == OBJECT_RED);
+    if (isOpponent) {
+      if (pendingEjectCount < MAX_PENDING_EJECTS) {
+        pendingEjects[pendingEjectCount++] = rollerPosition + ejectTravelDeg;
+      } else {
+        objectsMissed++;
+      }
+    }
+  }
+
+  // Fire early by the distance the rollers travel during the actuation latency,
+  // so the eject lands on the object regardless of roller speed.
+  float leadDeg = rollerVelocity * ejectLatency / 1000.0;
+  while (pendingEjectCount > 0 && rollerPosition + leadDeg >= pendingEjects[0]) {
+    for (int i = 1; i < pendingEjectCount; i++) pendingEjects[i - 1] = pendingEjects[i];
+    pendingEjectCount--;
+    objectsEjected++;
+    ejectEndTime = now + ejectLatency + ejectTime;
+    if (!ejecting) {
+      ejecting = true;
+      ejectAction(true);
+    }
+  }
+}
+
+float ColorSort::getThroughput() {
+  if (objectsSeen < 2 || lastObjectTime <= firstObjectTime) return 0;
+  return (objectsSeen - 1) * 1000.0 / (lastObjectTime - firstObjectTime);
+}
+
+void ColorSort::resetStats() {
+  objectsSeen = 0;
+  objectsEjected = 0;
+  objectsMissed = 0;
+  firstObjectTime = 0;
+  lastObjectTime = 0;
+}
+
+void ColorSort::printStats() {
+  char statsMsg[30];
+  sprintf(statsMsg, "%d/%d/%d %.1f/s", objectsSeen, objectsEjected, objectsMissed, getThroughput());
+  printControllerScreen(statsMsg, MESSAGE_LOW);
+}
@@ -0,0 +1,185 @@
+#include "vex.h"
+
+Intake::Intake(ActuatorRegistry& actuators, int bottomRoller, int topRoller) :
+  actuators(actuators),
+  bottomRoller(bottomRoller),
+  topRoller(topRoller),
+  requestedState(INTAKE_STOP),
+  state(INTAKE_STOP),
+  manualBottomVoltage(0),
+  manualTopVoltage(0),
+  ejecting(false),
+  retries(0),
+  jamCount(0) {}
+
+void Intake::start() {
+  thread intakeThread = thread(intakeTask, this);
+}
+
+int Intake::intakeTask(void* intake) {
+  Intake* rollers = static_cast<Intake*>(intake);
+  while (true) {
+    rollers->update();
+    wait(10, msec);
+  }
+  return 0;
+}
+
+void Intake::set(intakeState state) {
+  if (state == INTAKE_UNJAM) return;
+  if (state != requestedState) {
+    requestedState = state;
+    retries = 0;
+  }
+}
+
+void Intake::setVoltage(float bottomVoltage, float topVoltage) {
+  manualBottomVoltage = bottomVoltage;
+  manualTopVoltage = topVoltage;
+  requestedState = INTAKE_MANUAL;
+  retries = 0;
+}
+
+void Intake::setEjecting(bool ejecting) {
+  this -> ejecting = ejecting;
+}
+
+intakeState Intake::getRequestedState() {
+  return requestedState;
+}
+
+intakeState Intake::getState() {
+  return state;
+}
+
+void Intake::setJamDetection(float jamVelocity, float jamCurrent, float jamTime) {
+  this -> jamVelocity = jamVelocity;
+  this -> jamCurrent = jamCurrent;
+  this -> jamTime = jamTime;
+}
+
+void Intake::setJamRecovery(float unjamTime, int maxRetries) {
+  this -> unjamTime = unjamTime;
+  this -> maxRetries = maxRetries;
+}
+
+int Intake::getJamCount() {
+  return jamCount;
+}
+
+float Intake::bottomVoltage(intakeState state) {
+  switch (state) {
+  case INTAKE_COLLECT:
+  case INTAKE_SCORE_LONG:
+    return 12;
+  case INTAKE_OUTTAKE:
+    return -12;
+  case INTAKE_UNJAM:
+    // Back the rollers out against the direction they jammed in.
+    return -bottomVoltage(requestedState);
+  case INTAKE_MANUAL:
+    return manualBottomVoltage;
+  default:
+    return 0;
+  }
+}
+
+float Intake::topVoltage(intakeState state) {
+  switch (state) {
+  case INTAKE_SCORE_LONG:
+    return 12;
+  case INTAKE_UNJAM:
+    return -topVoltage(requestedState);
+  case INTAKE_MANUAL:
+    return manualTopVoltage;
+  default:
+    return 0;
+  }
+}
+
+bool Intake::isStalled(int roller, float commandedVoltage) {
+  if (fabs(commandedVoltage) < 3) return false;
+  motor& device = actuators.getMotor(roller);
+  return fabs(device.velocity(rpm)) < jamVelocity && device.current(amp) > jamCurrent;
+}
+
+void Intake::applyOutput() {
+  if (ejecting && state != INTAKE_UNJAM) {
+    actuators.spin(bottomRoller, 12);
+    actuators.spin(topRoller, -12);
+    return;
+  }
+  switch (state) {
+  case INTAKE_STOP:
+    actuators.stop(bottomRoller, brake);
+    actuators.stop(topRoller, brake);
+    break;
+  case INTAKE_HOLD:
+    actuators.stop(bottomRoller, hold);
+    actuators.stop(topRoller, hold);
+    break;
+  case INTAKE_COLLECT:
+  case INTAKE_OUTTAKE:
+    // The top roller coasts so game objects stay in storage.
+    actuators.spin(bottomRoller, bottomVoltage(state));
+    actuators.stop(topRoller, coast);
+    break;
+  default:
+    actuators.spin(bottomRoller, bottomVoltage(state));
+    actuators.spin(topRoller, topVoltage(state));
+    break;
+  }
+}
+
+void Intake::update() {
+  float now = timer::system();
+
+  if (state == INTAKE_UNJAM) {
+    // Retry the requested state once the rollers have reversed long enough.
+    if (now < unjamEndTime) {
+      applyOutput();
+      return;
+    }
+    state = requestedState.load();
+    stallStartTime = -1;
+  } else if (state != requestedState) {
+    state = requestedState.load();
+    stallStartTime = -1;
+  }
+
+  // The registry only sends commands that changed, so the state is staged every tick.
+  applyOutput();
+  if (ejecting) return;
+
+  if (retries > 0 && now - lastJamTime > jamClearTime) retries = 0;
+
+  bool stalled = isStalled(bottomRoller, bottomVoltage(state)) || isStalled(topRoller, topVoltage(state));
+  if (!stalled) {
+    stallStartTime = -1;
+    return;
+  }
+  if (stallStartTime < 0) {
+    stallStartTime = now;
+    return;
+  }
+  if (now - stallStartTime < jamTime) return;
+
+  // A jam is detected.
+  jamCount++;
+  lastJamTime = now;
+  stallStartTime = -1;
+  if (retries >= maxRetries) {
+    // Give up so the motors do not overheat, and let the driver know.
+    requestedState = INTAKE_STOP;
+    state = INTAKE_STOP;
+    retries = 0;
+    applyOutput();
+    printControllerScreen("intake jammed", MESSAGE_HIGH, 2000);
+    rumbleController("---");
+    return;
+  }
+  retries++;
+  state = INTAKE_UNJAM;
+  unjamEndTime = now + unjamTime;
+  applyOutput();
+}
@@ -45,11 +45,16 @@ void buttonL2Action() {
 void buttonR2Action()
 {
   // brake the drivetrain until the button is released.
+  // The hold is a safety stop, so the driver loop and macros cannot drive while it is held.
+  chassisArbiter.bindThread(OWNER_SAFETY);
+  chassisArbiter.claim(OWNER_SAFETY);
   chassis.stop(hold);
-  controller1.rumble(".");
+  rumbleController(".");
   waitUntil(!controller1.ButtonR2.pressing());
   chassis.checkStatus();
   chassis.stop(coast);
+  chassisArbiter.release(OWNER_SAFETY);
+  chassisArbiter.unbindThread();
 }
 
 
@@ -84,7 +89,7 @@ void pollCommandMessages()
   
   if (command.empty()) return;
 
-  controller(primary).rumble(".");
+  rumbleController(".");
   printControllerScreen(command.c_str());
 
   // Parse command
@@ -121,10 +126,10 @@ int main() {
   Competition.drivercontrol(usercontrol);
 
   //comment out the following line to disable auton testing
-  if (DRIVE_MODE != -1) registerAutonTestButtons();
+  if (robotState.driveMode != -1) registerAutonTestButtons();
 
   // Set up other button mapping for the controller
-  if (DRIVE_MODE != -1) setupButtonMapping();
+  if (robotState.driveMode != -1) setupButtonMapping();
 
   // Run the pre-autonomous function.
   pre_auton();
@@ -16,8 +16,12 @@ PID::PID(float error, float kp, float ki, float kd, float starti, float settleEr
   timeout(timeout)
 {};
 
+void PID::setPreviousError(float previousError){
+  this->previousError = previousError;
+}
+
 float PID::compute(float error){
-  if (fabs(error) < starti){ // StartI is used to prevent integral windup.
+  if (fabsf(error) < starti){ // StartI is used to prevent integral windup.
     accumulatedError+=error;
   }
   if ((error>0 && previousError<0)||(error<0 && previousError>0)){ 
@@ -28,7 +32,7 @@ float PID::compute(float error){
 
   previousError=error;
 
-  if(fabs(error)<settleError){
+  if(fabsf(error)<settleError){
     timeSpentSettled+=10;
   } else {
     timeSpentSettled = 0;
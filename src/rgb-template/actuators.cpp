@@ -0,0 +1,127 @@
+#include "vex.h"
+
+int ActuatorRegistry::add(const char* name, motor& device, float maxVoltage, vex::brakeType defaultBrake) {
+  if (actuatorCount >= MAX_ACTUATORS) return -1;
+  Actuator& actuator = actuators[actuatorCount];
+  actuator.name = name;
+  actuator.device = &device;
+  actuator.maxVoltage = maxVoltage;
+  actuator.defaultBrake = defaultBrake;
+  actuator.commanded = true;
+  actuator.stagedStop = true;
+  actuator.stagedVoltage = 0;
+  actuator.stagedBrake = defaultBrake;
+  actuator.appliedValid = false;
+  return actuatorCount++;
+}
+
+int ActuatorRegistry::monitor(const char* name, motor& device) {
+  int id = add(name, device);
+  if (id >= 0) actuators[id].commanded = false;
+  return id;
+}
+
+void ActuatorRegistry::spin(int id, float voltage) {
+  if (id < 0 || id >= actuatorCount) return;
+  Actuator& actuator = actuators[id];
+  stageLock.lock();
+  actuator.stagedStop = false;
+  actuator.stagedVoltage = clampf(voltage, -actuator.maxVoltage, actuator.maxVoltage);
+  stageLock.unlock();
+}
+
+void ActuatorRegistry::stop(int id) {
+  if (id < 0 || id >= actuatorCount) return;
+  stop(id, actuators[id].defaultBrake);
+}
+
+void ActuatorRegistry::stop(int id, vex::brakeType mode) {
+  if (id < 0 || id >= actuatorCount) return;
+  Actuator& actuator = actuators[id];
+  stageLock.lock();
+  actuator.stagedStop = true;
+  actuator.stagedVoltage = 0;
+  actuator.stagedBrake = mode;
+  stageLock.unlock();
+}
+
+void ActuatorRegistry::flush() {
+  for (int i = 0; i < actuatorCount; i++) {
+    Actuator& actuator = actuators[i];
+    if (!actuator.commanded) continue;
+    stageLock.lock();
+    bool isStop = actuator.stagedStop;
+    float voltage = actuator.stagedVoltage;
+    vex::brakeType mode = actuator.stagedBrake;
+    stageLock.unlock();
+
+    bool unchanged = actuator.appliedValid && actuator.appliedStop == isStop
+      && (isStop ? actuator.appliedBrake == mode : actuator.appliedVoltage == voltage);
+    if (unchanged) {
+      commandsSkipped++;
+      continue;
+    }
+    if (isStop) {
+      actuator.device->stop(mode);
+    } else {
+      actuator.device->spin(fwd, voltage, volt);
+    }
+    actuator.appliedValid = true;
+    actuator.appliedStop = isStop;
+    actuator.appliedVoltage = voltage;
+    actuator.appliedBrake = mode;
+    commandsSent++;
+  }
+}
+
+void ActuatorRegistry::start(int period) {
+  flushPeriod = period;
+  thread flushThread = thread(flushTask, this);
+}
+
+int ActuatorRegistry::flushTask(void* registry) {
+  ActuatorRegistry* actuators = static_cast<ActuatorRegistry*>(registry);
+  while (true) {
+    actuators->flush();
+    wait(actuators->flushPeriod, msec);
+  }
+  return 0;
+}
+
+int ActuatorRegistry::getCount() {
+  return actuatorCount;
+}
+
+const char* ActuatorRegistry::getName(int id) {
+  return actuators[id].name;
+}
+
+motor& ActuatorRegistry::getMotor(int id) {
+  return *actuators[id].device;
+}
+
+int ActuatorRegistry::getCommandsSent() {
+  return commandsSent;
+}
+
+int ActuatorRegistry::getCommandsSkipped() {
+  return commandsSkipped;
+}
+
+bool ActuatorRegistry::checkHealth(int temperatureLimit) {
+  char healthMsg[30];
+  for (int i = 0; i < actuatorCount; i++) {
+    motor& device = *actuators[i].device;
+    if (!device.installed()) {
+      sprintf(healthMsg, "%s disconnected", actuators[i].name);
+    } else if (device.temperature(celsius) > temperatureLimit) {
+      sprintf(healthMsg, "%s is %dC", actuators[i].name, (int)device.temperature(celsius));
+    } else {
+      continue;
+    }
+    printControllerScreen(healthMsg, MESSAGE_HIGH, 2000);
+    rumbleController("---");
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,126 @@
+#include "vex.h"
+
+// "RGBS" in little-endian order.
+static const uint32_t SELECTION_MAGIC = 0x53424752;
+
+const char* const AutonSelector::slotFiles[2] = {"auton_a.bin", "auton_b.bin"};
+const char* const AutonSelector::legacyFile = "parameters.txt";
+
+AutonSelector::AutonSelector(rotation& dial) :
+  dial(dial) {}
+
+int AutonSelector::poll(int selection, int autonCount) {
+  if (autonCount <= 0) return selection;
+
+  if (dial.installed()) {
+    float sliceSize = 360.0f / autonCount;
+    float angle = wrap360(dial.angle(deg));
+    int slice = (int)(angle / sliceSize) % autonCount;
+    float intoSlice = angle - slice * sliceSize;
+    if (dialSlice < 0) {
+      // Keep the saved selection until the dial is turned.
+      dialSlice = slice;
+    } else if (slice != dialSlice && intoSlice > dialMargin && intoSlice < sliceSize - dialMargin) {
+      dialSlice = slice;
+      selection = slice;
+    }
+  }
+
+  if (isChordHeld()) {
+    int pressed = -1;
+    if (controller1.ButtonUp.pressing()) pressed = 0;
+    else if (controller1.ButtonRight.pressing()) pressed = 1;
+    else if (controller1.ButtonDown.pressing()) pressed = 2;
+    else if (controller1.ButtonLeft.pressing()) pressed = 3;
+    if (pressed >= 0 && pressed < autonCount) selection = pressed;
+  }
+  return selection;
+}
+
+bool AutonSelector::isChordHeld() {
+  return controller1.ButtonB.pressing();
+}
+
+uint32_t AutonSelector::checksum(const SelectionRecord& record) {
+  // FNV-1a over every field before the checksum.
+  const uint8_t* bytes = (const uint8_t*)&record;
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < sizeof(record) - sizeof(record.checksum); i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+bool AutonSelector::readSlot(int slot, SelectionRecord& record) {
+  int32_t size = Brain.SDcard.loadfile(slotFiles[slot], (uint8_t*)&record, sizeof(record));
+  return size == sizeof(record) && record.magic == SELECTION_MAGIC && record.checksum == checksum(record);
+}
+
+bool AutonSelector::load(int autonCount, int driveModeCount) {
+  if (!Brain.SDcard.isInserted()) return false;
+  SelectionRecord records[2];
+  bool valid[2] = {readSlot(0, records[0]), readSlot(1, records[1])};
+  if (!valid[0] && !valid[1]) return loadLegacy(autonCount, driveModeCount);
+
+  int newest = valid[0] ? 0 : 1;
+  if (valid[0] && valid[1] && records[1].sequence > records[0].sequence) newest = 1;
+  newestSlot = newest;
+  sequence = records[newest].sequence;
+  // -1 is the quick test and disabled driving.
+  if (records[newest].autonSelection < -1 || records[newest].autonSelection >= autonCount) return false;
+  if (records[newest].driveMode < -1 || records[newest].driveMode >= driveModeCount) return false;
+  robotState.autonSelection = records[newest].autonSelection;
+  robotState.driveMode = records[newest].driveMode;
+  return true;
+}
+
+bool AutonSelector::loadLegacy(int autonCount, int driveModeCount) {
+  if (!Brain.SDcard.exists(legacyFile)) return false;
+  char text[256];
+  int32_t size = Brain.SDcard.loadfile(legacyFile, (uint8_t*)text, sizeof(text) - 1);
+  if (size <= 0) return false;
+  text[size] = 0;
+
+  // The file has one "key = value" line for each setting.
+  int autonSelection = -1;
+  int driveMode = robotState.driveMode;
+  for (char* line = text; line != nullptr && *line != 0; line = strchr(line, '\n')) {
+    while (*line == '\n' || *line == '\r') line++;
+    int value;
+    if (sscanf(line, " auton = %d", &value) == 1) autonSelection = value;
+    else if (sscanf(line, " drive_mode = %d", &value) == 1) driveMode = value;
+  }
+  if (autonSelection < -1 || autonSelection >= autonCount) return false;
+  if (driveMode < -1 || driveMode >= driveModeCount) return false;
+  robotState.autonSelection = autonSelection;
+  robotState.driveMode = driveMode;
+  // Moves the selection to the new files, so the old one is only read once.
+  save();
+  return true;
+}
+
+bool AutonSelector::save() {
+  saveDueTime = 0;
+  if (!Brain.SDcard.isInserted()) return false;
+  SelectionRecord record;
+  record.magic = SELECTION_MAGIC;
+  record.sequence = sequence + 1;
+  record.autonSelection = robotState.autonSelection;
+  record.driveMode = robotState.driveMode;
+  record.checksum = checksum(record);
+
+  // Overwrite the older slot, so the newest complete record survives a failed write.
+  int slot = 1 - newestSlot;
+  if (Brain.SDcard.savefile(slotFiles[slot], (uint8_t*)&record, sizeof(record)) != sizeof(record)) return false;
+  newestSlot = slot;
+  sequence = record.sequence;
+  return true;
+}
+
+void AutonSelector::scheduleSave(uint32_t delay) {
+  saveDueTime = timer::system() + delay;
+}
+
+void AutonSelector::saveIfDue() {
+  if (saveDueTime != 0 && timer::system() >= saveDueTime) save();
+}
@@ -0,0 +1,131 @@
+#include "vex.h"
+
+ChassisArbiter::ChassisArbiter() :
+  activeSources(0)
+{
+  resetStats();
+}
+
+driveOwner ChassisArbiter::highestSource(int sources) {
+  for (int source = OWNER_COUNT - 1; source > OWNER_NONE; source--) {
+    if (sources & (1 << source)) return (driveOwner)source;
+  }
+  return OWNER_NONE;
+}
+
+void ChassisArbiter::claim(driveOwner source) {
+  commandLock.lock();
+  driveOwner winner = highestSource(activeSources);
+  if (winner != OWNER_NONE && source > winner) preemptions[winner]++;
+  activeSources |= 1 << source;
+  robotState.drivetrainOwner = highestSource(activeSources);
+  commandLock.unlock();
+}
+
+void ChassisArbiter::release(driveOwner source) {
+  commandLock.lock();
+  activeSources &= ~(1 << source);
+  robotState.drivetrainOwner = highestSource(activeSources);
+  commandLock.unlock();
+}
+
+driveOwner ChassisArbiter::getWinner() {
+  return highestSource(activeSources);
+}
+
+void ChassisArbiter::reset() {
+  commandLock.lock();
+  activeSources &= 1 << OWNER_DRIVER;
+  boundCount = 0;
+  robotState.drivetrainOwner = highestSource(activeSources);
+  commandLock.unlock();
+}
+
+bool ChassisArbiter::bindThread(driveOwner source) {
+  int32_t id = this_thread::get_id();
+  commandLock.lock();
+  int slot = 0;
+  while (slot < boundCount && boundThreads[slot] != id) slot++;
+  bool bound = slot < MAX_BOUND_THREADS;
+  if (bound) {
+    boundThreads[slot] = id;
+    boundSources[slot] = source;
+    if (slot == boundCount) boundCount++;
+  }
+  commandLock.unlock();
+  if (!bound) {
+    // The thread would command as the driver, so say so rather than let it drive unnoticed.
+    printControllerScreen("arbiter: no thread slot", MESSAGE_HIGH, 2000);
+    rumbleController("---");
+  }
+  return bound;
+}
+
+void ChassisArbiter::unbindThread() {
+  int32_t id = this_thread::get_id();
+  commandLock.lock();
+  for (int i = 0; i < boundCount; i++) {
+    if (boundThreads[i] == id) {
+      boundCount--;
+      boundThreads[i] = boundThreads[boundCount];
+      boundSources[i] = boundSources[boundCount];
+      break;
+    }
+  }
+  commandLock.unlock();
+}
+
+driveOwner ChassisArbiter::getThreadSource() {
+  int32_t id = this_thread::get_id();
+  driveOwner source = OWNER_DRIVER;
+  commandLock.lock();
+  for (int i = 0; i < boundCount; i++) {
+    if (boundThreads[i] == id) source = boundSources[i];
+  }
+  commandLock.unlock();
+  return source;
+}
+
+bool ChassisArbiter::allowCommand(driveOwner source) {
+  commandLock.lock();
+  // Sources without a claim may still drive while no one else does, e.g. before the match starts.
+  bool allowed = source >= highestSource(activeSources);
+  commandLock.unlock();
+  if (allowed) {
+    commandsSent[source]++;
+  } else {
+    commandsOverridden[source]++;
+  }
+  return allowed;
+}
+
+int ChassisArbiter::getCommandsSent(driveOwner source) {
+  return commandsSent[source];
+}
+
+int ChassisArbiter::getCommandsOverridden(driveOwner source) {
+  return commandsOverridden[source];
+}
+
+int ChassisArbiter::getPreemptions(driveOwner source) {
+  return preemptions[source];
+}
+
+void ChassisArbiter::resetStats() {
+  for (int i = 0; i < OWNER_COUNT; i++) {
+    commandsSent[i] = 0;
+    commandsOverridden[i] = 0;
+    preemptions[i] = 0;
+  }
+}
+
+void ChassisArbiter::formatStats(char* text, int size) {
+  snprintf(text, size, "ovr d%d m%d a%d", commandsOverridden[OWNER_DRIVER].load(),
+    commandsOverridden[OWNER_MACRO].load(), commandsOverridden[OWNER_AUTON].load());
+}
+
+void ChassisArbiter::printStats() {
+  char statsMsg[30];
+  formatStats(statsMsg, sizeof(statsMsg));
+  printControllerScreen(statsMsg, MESSAGE_LOW);
+}
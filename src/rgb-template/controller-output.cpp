@@ -0,0 +1,137 @@
+#include "vex.h"
+
+ControllerOutput::ControllerOutput() {
+  shown.text[0] = '\0';
+  shown.priority = MESSAGE_LOW;
+  shown.holdTime = 0;
+  shown.sequence = 0;
+}
+
+void ControllerOutput::start(uint32_t writeInterval) {
+  this -> writeInterval = writeInterval;
+  thread outputThread = thread(outputTask, this);
+}
+
+int ControllerOutput::outputTask(void* output) {
+  ControllerOutput* controllerOutput = static_cast<ControllerOutput*>(output);
+  while (true) {
+    controllerOutput->update();
+    wait(10, msec);
+  }
+  return 0;
+}
+
+void ControllerOutput::print(const char* text, messagePriority priority, uint32_t holdTime) {
+  char padded[25];
+  snprintf(padded, sizeof(padded), "%-24s", text);
+
+  queueLock.lock();
+  for (int i = 0; i < messageCount; i++) {
+    if (strcmp(messages[i].text, padded) == 0) {
+      // Keep the queue position of the earlier copy but the strongest priority and hold.
+      if (priority > messages[i].priority) messages[i].priority = priority;
+      if (holdTime > messages[i].holdTime) messages[i].holdTime = holdTime;
+      messagesCoalesced++;
+      queueLock.unlock();
+      return;
+    }
+  }
+  if (messageCount == 0 && strcmp(shown.text, padded) == 0) {
+    messagesCoalesced++;
+    queueLock.unlock();
+    return;
+  }
+
+  int slot = messageCount;
+  if (messageCount == MAX_MESSAGES) {
+    // Replace the oldest message of the lowest priority, unless the new message is lower still.
+    slot = 0;
+    for (int i = 1; i < messageCount; i++) {
+      if (messages[i].priority < messages[slot].priority ||
+          (messages[i].priority == messages[slot].priority && messages[i].sequence < messages[slot].sequence)) {
+        slot = i;
+      }
+    }
+    messagesDropped++;
+    if (priority < messages[slot].priority) {
+      queueLock.unlock();
+      return;
+    }
+  } else {
+    messageCount++;
+  }
+  strncpy(messages[slot].text, padded, sizeof(messages[slot].text));
+  messages[slot].priority = priority;
+  messages[slot].holdTime = holdTime;
+  messages[slot].sequence = nextSequence++;
+  queueLock.unlock();
+}
+
+void ControllerOutput::rumble(const char* pattern) {
+  queueLock.lock();
+  bool repeated = rumbleCount > 0 && strncmp(rumbles[rumbleCount - 1], pattern, 8) == 0;
+  if (!repeated && rumbleCount < MAX_RUMBLES) {
+    strncpy(rumbles[rumbleCount], pattern, 8);
+    rumbles[rumbleCount][8] = '\0';
+    rumbleCount++;
+  }
+  queueLock.unlock();
+}
+
+int ControllerOutput::nextMessage(uint32_t now) {
+  int next = -1;
+  for (int i = 0; i < messageCount; i++) {
+    if (next < 0 || messages[i].priority > messages[next].priority ||
+        (messages[i].priority == messages[next].priority && messages[i].sequence < messages[next].sequence)) {
+      next = i;
+    }
+  }
+  if (next < 0) return -1;
+  bool held = now - shownTime < shown.holdTime;
+  if (held && messages[next].priority <= shown.priority) return -1;
+  return next;
+}
+
+void ControllerOutput::update() {
+  uint32_t now = timer::system();
+  if (now < nextWriteTime) return;
+
+  queueLock.lock();
+  int next = nextMessage(now);
+  if (next >= 0) {
+    shown = messages[next];
+    messages[next] = messages[--messageCount];
+    queueLock.unlock();
+    shownTime = now;
+    messagesShown++;
+    controller1.Screen.setCursor(1, 1);
+    controller1.Screen.print("%s", shown.text);
+    nextWriteTime = now + writeInterval;
+    return;
+  }
+  if (rumbleCount > 0 && now >= rumbleEndTime) {
+    char pattern[9];
+    strcpy(pattern, rumbles[0]);
+    for (int i = 1; i < rumbleCount; i++) strcpy(rumbles[i - 1], rumbles[i]);
+    rumbleCount--;
+    queueLock.unlock();
+    controller1.rumble(pattern);
+    // Let each pattern finish before the next one starts, at about 200 msec per symbol.
+    rumbleEndTime = now + strlen(pattern) * 200;
+    nextWriteTime = now + writeInterval;
+    return;
+  }
+  queueLock.unlock();
+}
+
+int ControllerOutput::getMessagesShown() {
+  return messagesShown;
+}
+
+int ControllerOutput::getMessagesCoalesced() {
+  return messagesCoalesced;
+}
+
+int ControllerOutput::getMessagesDropped() {
+  return messagesDropped;
+}
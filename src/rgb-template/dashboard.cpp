@@ -0,0 +1,126 @@
+#include "vex.h"
+
+DashboardWidget dashboardWidget(int x, int y, int width, int height, fontType font, widgetFormatter format) {
+  DashboardWidget widget;
+  widget.x = x;
+  widget.y = y;
+  widget.width = width;
+  widget.height = height;
+  widget.font = font;
+  widget.format = format;
+  widget.drawn[0] = '\0';
+  widget.valid = false;
+  return widget;
+}
+
+static void clearBrainScreen(void* target) {
+  Brain.Screen.clearScreen();
+}
+
+static void clearBrainBox(void* target, int x, int y, int width, int height) {
+  Brain.Screen.setPenColor(black);
+  Brain.Screen.setFillColor(black);
+  Brain.Screen.drawRectangle(x, y, width, height);
+}
+
+static void printBrainText(void* target, int x, int y, fontType font, const char* text) {
+  Brain.Screen.setPenColor(white);
+  Brain.Screen.setFont(font);
+  Brain.Screen.printAt(x, y, true, "%s", text);
+}
+
+DashboardCanvas brainScreenCanvas() {
+  DashboardCanvas canvas = {nullptr, clearBrainScreen, clearBrainBox, printBrainText};
+  return canvas;
+}
+
+Dashboard::Dashboard(DashboardWidget* widgets, int widgetCount) :
+  widgets(widgets),
+  canvas(brainScreenCanvas()),
+  widgetCount(widgetCount) {}
+
+void Dashboard::setCanvas(const DashboardCanvas& canvas) {
+  this -> canvas = canvas;
+  invalidate();
+}
+
+void Dashboard::start(int period, uint32_t frameBudget) {
+  this -> period = period;
+  this -> frameBudget = frameBudget;
+  canvas.clear(canvas.target);
+  invalidate();
+  thread renderThread = thread(renderTask, this);
+  // Drawing is the least urgent work on the robot, so it only runs when the control loops are idle.
+  renderThread.setPriority(thread::threadPriorityLow);
+}
+
+int Dashboard::renderTask(void* dashboard) {
+  Dashboard* screen = static_cast<Dashboard*>(dashboard);
+  while (true) {
+    screen->renderFrame();
+    wait(screen->period, msec);
+  }
+  return 0;
+}
+
+void Dashboard::invalidate() {
+  for (int i = 0; i < widgetCount; i++) widgets[i].valid = false;
+}
+
+void Dashboard::draw(DashboardWidget& widget, const char* text) {
+  canvas.clearBox(canvas.target, widget.x, widget.y, widget.width, widget.height);
+  // The text is placed by its baseline, so leave room below it for descenders.
+  canvas.printText(canvas.target, widget.x + 4, widget.y + widget.height - 8, widget.font, text);
+  strncpy(widget.drawn, text, WIDGET_TEXT_SIZE);
+  widget.valid = true;
+}
+
+void Dashboard::renderFrame() {
+  uint64_t frameStart = timer::systemHighResolution();
+  for (int i = 0; i < widgetCount; i++) {
+    DashboardWidget& widget = widgets[nextWidget];
+    nextWidget = (nextWidget + 1) % widgetCount;
+
+    char text[WIDGET_TEXT_SIZE];
+    widget.format(text, WIDGET_TEXT_SIZE);
+    if (widget.valid && strcmp(text, widget.drawn) == 0) continue;
+    draw(widget, text);
+    widgetsRedrawn++;
+
+    if (timer::systemHighResolution() - frameStart > frameBudget) {
+      framesOverBudget++;
+      break;
+    }
+  }
+  frameTime = timer::systemHighResolution() - frameStart;
+  if (frameTime > maxFrameTime) maxFrameTime = frameTime;
+  frames++;
+}
+
+int Dashboard::getFrames() {
+  return frames;
+}
+
+int Dashboard::getWidgetsRedrawn() {
+  return widgetsRedrawn;
+}
+
+int Dashboard::getFramesOverBudget() {
+  return framesOverBudget;
+}
+
+uint32_t Dashboard::getFrameTime() {
+  return frameTime;
+}
+
+uint32_t Dashboard::getMaxFrameTime() {
+  return maxFrameTime;
+}
+
+void Dashboard::resetStats() {
+  frames = 0;
+  widgetsRedrawn = 0;
+  framesOverBudget = 0;
+  frameTime = 0;
+  maxFrameTime = 0;
+}
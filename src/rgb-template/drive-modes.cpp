@@ -0,0 +1,29 @@
+#include "vex.h"
+
+int DriveModes::select(int index) {
+  if (index >= modeCount) index = 0;
+  if (index < 0) {
+    selected = -1;
+    activeControl = controlNothing;
+    activeMode = nullptr;
+    return selected;
+  }
+  selected = index;
+  chassis.setDriveLimits(modes[index].limits);
+  activeControl = modes[index].control;
+  activeMode = modes[index].mode;
+  return selected;
+}
+
+int DriveModes::getSelected() {
+  return selected;
+}
+
+int DriveModes::getCount() {
+  return modeCount;
+}
+
+const char* DriveModes::getName() {
+  if (selected < 0) return "Drive Disabled";
+  return modes[selected].name;
+}
@@ -0,0 +1,180 @@
+#include "vex.h"
+
+void DriveSimulation::reset(const DriveModel& model) {
+  this -> model = model;
+  velocity = 0;
+  turnRate = 0;
+  leftPosition = 0;
+  rightPosition = 0;
+  heading = 0;
+  leftVoltage = 0;
+  rightVoltage = 0;
+  perturbation = NO_PERTURBATION;
+  headingDriftTotal = 0;
+  x = 0;
+  y = 0;
+  sensedX = 0;
+  sensedY = 0;
+  ticks = 0;
+  controlTime = 0;
+  tracking = false;
+  lastStepEnd = clock();
+}
+
+void DriveSimulation::setClock(uint64_t (*clock)()) {
+  this -> clock = clock != nullptr ? clock : systemClock;
+}
+
+void DriveSimulation::setPerturbation(const Perturbation& perturbation) {
+  this -> perturbation = perturbation;
+}
+
+void DriveSimulation::setTarget(bool turning, float target) {
+  this -> turning = turning;
+  this -> target = target;
+  trackStart = turning ? heading : (leftPosition + rightPosition) * 0.5f;
+  peakProgress = 0;
+  arrivalTick = -1;
+  tracking = true;
+}
+
+uint64_t DriveSimulation::systemClock() {
+  return timer::systemHighResolution() * 1000;
+}
+
+float DriveSimulation::accelerate(float speed, float voltage, float kS, float kV, float kA, float dt) {
+  // Static friction holds the robot until the voltage overcomes it.
+  if (speed == 0 && fabsf(voltage) <= kS) return 0;
+  float direction = speed != 0 ? (speed > 0 ? 1 : -1) : (voltage > 0 ? 1 : -1);
+  float next = speed + (voltage - kS * direction - kV * speed) / kA * dt;
+  // Friction stops the robot rather than reversing it.
+  if (next * speed < 0 && fabsf(voltage) <= kS) return 0;
+  return next;
+}
+
+void DriveSimulation::step() {
+  controlTime += clock() - lastStepEnd;
+
+  // A low battery or a hot motor delivers less than the commanded voltage.
+  float driveVoltage = (leftVoltage + rightVoltage) * 0.5f * perturbation.voltageScale;
+  float turnVoltage = (leftVoltage - rightVoltage) * 0.5f * perturbation.voltageScale;
+  float dt = TICK / SUBSTEPS;
+  for (int i = 0; i < SUBSTEPS; i++) {
+    velocity = accelerate(velocity, driveVoltage, model.driveKs, model.driveKv, model.driveKa, dt);
+    turnRate = accelerate(turnRate, turnVoltage, model.turnKs, model.turnKv, model.turnKa, dt);
+    // The speed of each side from turning, for a turn rate in deg/sec.
+    float turnSpeed = turnRate * (float)M_PI / 180 * model.trackWidth * 0.5f;
+    leftPosition += (velocity + turnSpeed) * dt;
+    rightPosition += (velocity - turnSpeed) * dt;
+    heading += turnRate * dt;
+    headingDriftTotal += perturbation.headingDrift * dt;
+    // Dead reckons the move both from the real motion and from the sensors, with heading 0 along y.
+    float distance = velocity * dt;
+    float trueRadians = heading * (float)M_PI / 180;
+    float sensedRadians = (heading + headingDriftTotal) * (float)M_PI / 180;
+    x += distance * sinf(trueRadians);
+    y += distance * cosf(trueRadians);
+    sensedX += distance * perturbation.encoderScale * sinf(sensedRadians);
+    sensedY += distance * perturbation.encoderScale * cosf(sensedRadians);
+  }
+  ticks++;
+
+  if (tracking) {
+    float progress = getProgress();
+    float towardsTarget = target < 0 ? -progress : progress;
+    if (towardsTarget > peakProgress) peakProgress = towardsTarget;
+    if (arrivalTick < 0 && fabsf(target - progress) <= 1) arrivalTick = ticks;
+  }
+  if (ticks >= MAX_TICKS) robotState.drivetrainNeedsStopped = true;
+  // The motions do not wait while simulating, so let the other tasks run now and then.
+  if (ticks % 100 == 0) this_thread::yield();
+  lastStepEnd = clock();
+}
+
+void DriveSimulation::setVoltage(float leftVoltage, float rightVoltage) {
+  this -> leftVoltage = leftVoltage;
+  this -> rightVoltage = rightVoltage;
+}
+
+void DriveSimulation::stop(vex::brakeType mode) {
+  leftVoltage = 0;
+  rightVoltage = 0;
+  if (mode == coast) return;
+  velocity = 0;
+  turnRate = 0;
+}
+
+void DriveSimulation::resetPosition() {
+  leftPosition = 0;
+  rightPosition = 0;
+  if (tracking && !turning) trackStart = 0;
+}
+
+void DriveSimulation::setHeading(float heading) {
+  this -> heading = heading;
+  headingDriftTotal = 0;
+  if (tracking && turning) trackStart = heading;
+}
+
+float DriveSimulation::getHeading() {
+  float reading = heading + headingDriftTotal;
+  if (perturbation.headingNoise > 0) reading += perturbation.headingNoise * (2.0f * rand() / RAND_MAX - 1.0f);
+  return wrap360(reading);
+}
+
+float DriveSimulation::getLeftPosition() {
+  return leftPosition * perturbation.encoderScale;
+}
+
+float DriveSimulation::getRightPosition() {
+  return rightPosition * perturbation.encoderScale;
+}
+
+float DriveSimulation::getLeftVelocity() {
+  float turnSpeed = turnRate * (float)M_PI / 180 * model.trackWidth * 0.5f;
+  return (velocity + turnSpeed) * perturbation.encoderScale;
+}
+
+float DriveSimulation::getRightVelocity() {
+  float turnSpeed = turnRate * (float)M_PI / 180 * model.trackWidth * 0.5f;
+  return (velocity - turnSpeed) * perturbation.encoderScale;
+}
+
+float DriveSimulation::getTrueHeading() {
+  return wrap360(heading);
+}
+
+float DriveSimulation::getTrueX() {
+  return x;
+}
+
+float DriveSimulation::getTrueY() {
+  return y;
+}
+
+float DriveSimulation::getPoseError() {
+  return sqrtf((x - sensedX) * (x - sensedX) + (y - sensedY) * (y - sensedY));
+}
+
+float DriveSimulation::getProgress() {
+  if (!tracking) return 0;
+  return (turning ? heading : (leftPosition + rightPosition) * 0.5f) - trackStart;
+}
+
+int DriveSimulation::getTicks() {
+  return ticks;
+}
+
+float DriveSimulation::getTickCpuTime() {
+  return ticks > 0 ? controlTime / 1000.0f / ticks : 0;
+}
+
+float DriveSimulation::getOvershoot() {
+  if (!tracking) return 0;
+  return fmaxf(peakProgress - fabsf(target), 0);
+}
+
+int DriveSimulation::getSettleTicks() {
+  if (!tracking) return 0;
+  return arrivalTick < 0 ? ticks : ticks - arrivalTick;
+}
@@ -4,6 +4,8 @@ Drive::Drive(motor_group leftDrive, motor_group rightDrive, inertial gyro, float
   wheelDiameter(wheelDiameter),
   gearRatio(gearRatio),
   driveInToDegRatio(gearRatio / 360.0 * M_PI * wheelDiameter),
+  throttleCurveMin(curveMinimum(kThrottle)),
+  turnCurveMin(curveMinimum(kTurn)),
   leftDrive(leftDrive),
   rightDrive(rightDrive),
   gyro(gyro) {}
@@ -24,6 +26,47 @@ void Drive::setDrivePID(float driveMaxVoltage, float driveKp, float driveKi, flo
   this -> driveStarti = driveStarti;
 }
 
+void Drive::setDriveFeedforward(float driveKs, float driveKv, float driveKa) {
+  this -> driveKs = driveKs;
+  this -> driveKv = driveKv;
+  this -> driveKa = driveKa;
+}
+
+void Drive::setTurnSchedule(const TurnGains* turnSchedule, int turnScheduleSize) {
+  this -> turnSchedule = turnSchedule;
+  this -> turnScheduleSize = turnScheduleSize;
+}
+
+void Drive::setTurnFeedforward(float turnKs, float turnKv, float turnKa) {
+  this -> turnKs = turnKs;
+  this -> turnKv = turnKv;
+  this -> turnKa = turnKa;
+}
+
+void Drive::setSwingPID(float swingMaxVoltage, float swingKp, float swingKi, float swingKd, float swingStarti) {
+  this -> swingMaxVoltage = swingMaxVoltage;
+  this -> swingKp = swingKp;
+  this -> swingKi = swingKi;
+  this -> swingKd = swingKd;
+  this -> swingStarti = swingStarti;
+}
+
+void Drive::setSwingExitConditions(float swingSettleError, float swingSettleTime, float swingTimeout) {
+  this -> swingSettleError = swingSettleError;
+  this -> swingSettleTime = swingSettleTime;
+  this -> swingTimeout = swingTimeout;
+}
+
+void Drive::setTrackWidth(float trackWidth) {
+  this -> trackWidth = trackWidth;
+}
+
+void Drive::setArcExitConditions(float arcSettleError, float arcSettleTime, float arcTimeout) {
+  this -> arcSettleError = arcSettleError;
+  this -> arcSettleTime = arcSettleTime;
+  this -> arcTimeout = arcTimeout;
+}
+
 void Drive::setHeadingPID(float headingMaxVoltage, float headingKp, float headingKd) {
   this -> headingMaxVoltage = headingMaxVoltage;
   this -> headingKp = headingKp;
@@ -43,26 +86,122 @@ void Drive::setDriveExitConditions(float driveSettleError, float driveSettleTime
 }
 
 void Drive::setHeading(float orientationDeg) {
-  gyro.setHeading(orientationDeg, deg);
-  desiredHeading = orientationDeg;
+  // A replay reads the heading from the log, so the inertial sensor is left alone.
+  if (motionLog.isReplaying()) {
+    robotState.desiredHeading = orientationDeg;
+    return;
+  }
+  if (simulation) simulation->setHeading(orientationDeg);
+  else gyro.setHeading(orientationDeg, deg);
+  robotState.desiredHeading = orientationDeg;
 }
 
 float Drive::getHeading() {
-  return (gyro.heading());
+  if (motionLog.isReplaying()) return motionLog.current().heading;
+  if (simulation) return simulation->getHeading();
+  float heading = gyro.heading();
+  motionLog.noteHeading(heading);
+  return heading;
+}
+
+void Drive::setSimulation(DriveSimulation* simulation) {
+  this -> simulation = simulation;
+}
+
+float Drive::getDistanceTraveled() {
+  return (getLeftPositionIn() + getRightPositionIn()) * 0.5f;
+}
+
+float Drive::getHeadingMaxVoltage() {
+  return headingMaxVoltage;
 }
 
 float Drive::getLeftPositionIn() {
-  return (leftDrive.position(deg) * driveInToDegRatio);
+  if (motionLog.isReplaying()) return motionLog.current().leftPosition;
+  if (simulation) return simulation->getLeftPosition();
+  float position = leftDrive.position(deg) * driveInToDegRatio;
+  motionLog.noteLeftPosition(position);
+  return position;
 }
 
 float Drive::getRightPositionIn() {
-  return (rightDrive.position(deg) * driveInToDegRatio);
+  if (motionLog.isReplaying()) return motionLog.current().rightPosition;
+  if (simulation) return simulation->getRightPosition();
+  float position = rightDrive.position(deg) * driveInToDegRatio;
+  motionLog.noteRightPosition(position);
+  return position;
+}
+
+void Drive::waitTick() {
+  if (simulation) {
+    simulation->step();
+    return;
+  }
+  if (!motionLog.isReplaying()) {
+    wait(10, msec);
+    return;
+  }
+  // End the motion in progress once the log is used up.
+  if (!motionLog.advance()) robotState.drivetrainNeedsStopped = true;
+}
+
+void Drive::waitTime(float time) {
+  if (motionLog.isReplaying()) return;
+  if (!simulation) {
+    wait(time, msec);
+    return;
+  }
+  for (int i = 0; i * 10 < time; i++) simulation->step();
 }
 
 void Drive::driveWithVoltage(float leftVoltage, float rightVoltage) {
+  if (motionLog.isReplaying()) {
+    motionLog.compare(leftVoltage, rightVoltage);
+    return;
+  }
+  if (simulation) {
+    simulation->setVoltage(leftVoltage, rightVoltage);
+    return;
+  }
+  if (chassisArbiter.allowCommand(chassisArbiter.getThreadSource())) {
+    leftDrive.spin(fwd, leftVoltage, volt);
+    rightDrive.spin(fwd, rightVoltage, volt);
+    motionLog.record(leftVoltage, rightVoltage);
+  }
+}
 
-  leftDrive.spin(fwd, leftVoltage, volt);
-  rightDrive.spin(fwd, rightVoltage, volt);
+void Drive::stopMotors(vex::brakeType mode) {
+  if (motionLog.isReplaying()) return;
+  if (simulation) {
+    simulation->stop(mode);
+    return;
+  }
+  if (chassisArbiter.allowCommand(chassisArbiter.getThreadSource())) {
+    leftDrive.stop(mode);
+    rightDrive.stop(mode);
+  }
+}
+
+void Drive::swingWithVoltage(swingSide side, float voltage) {
+  if (motionLog.isReplaying()) {
+    motionLog.compare(side == SWING_LEFT ? voltage : 0, side == SWING_RIGHT ? voltage : 0);
+    return;
+  }
+  if (simulation) {
+    // The simulation has no brake on one side, so the held side is left unpowered.
+    simulation->setVoltage(side == SWING_LEFT ? voltage : 0, side == SWING_RIGHT ? voltage : 0);
+    return;
+  }
+  if (chassisArbiter.allowCommand(chassisArbiter.getThreadSource())) {
+    if (side == SWING_LEFT) {
+      leftDrive.spin(fwd, voltage, volt);
+      rightDrive.stop(hold);
+    } else {
+      leftDrive.stop(hold);
+      rightDrive.spin(fwd, voltage, volt);
+    }
+    motionLog.record(side == SWING_LEFT ? voltage : 0, side == SWING_RIGHT ? voltage : 0);
+  }
 }
 
 void Drive::turnToHeading(float heading) {
@@ -72,62 +211,457 @@ void Drive::turnToHeading(float heading) {
 void Drive::turnToHeading(float heading, float turnMaxVoltage, float earlyExitFactor) {
   if (earlyExitFactor > 5) earlyExitFactor = 5;
   if (earlyExitFactor < 1) earlyExitFactor = 1;
-  desiredHeading = normalize360(heading);
-  PID turnPID(normalize180(heading - getHeading()), turnKp, turnKi, turnKd, turnStarti, turnSettleError*earlyExitFactor , turnSettleTime/earlyExitFactor, turnTimeout);
-  while (!turnPID.isDone() && !drivetrainNeedsStopped) {
-    float error = normalize180(heading - getHeading());
+  if (turnScheduleSize > 0) {
+    turnProfiled(heading, turnMaxVoltage, earlyExitFactor, false);
+    return;
+  }
+  robotState.desiredHeading = wrap360(heading);
+  PID turnPID(wrap180(heading - getHeading()), turnKp, turnKi, turnKd, turnStarti, turnSettleError*earlyExitFactor , turnSettleTime/earlyExitFactor, turnTimeout);
+  while (!turnPID.isDone() && !robotState.drivetrainNeedsStopped) {
+    float error = wrap180(heading - getHeading());
     float output = turnPID.compute(error);
-    output = threshold(output, -turnMaxVoltage, turnMaxVoltage);
+    output = clampf(output, -turnMaxVoltage, turnMaxVoltage);
     driveWithVoltage(output, -output);
-    wait(10, msec);
+    waitTick();
+  }
+  if (earlyExitFactor == 1)
+  {
+    stopMotors(hold);
+  }
+}
+
+void Drive::turnProfiled(float heading, float turnMaxVoltage, float earlyExitFactor, bool chained) {
+  robotState.desiredHeading = wrap360(heading);
+  float turnAngle = wrap180(heading - getHeading());
+
+  // Small turns get stiffer gains and a short profile; large turns get a faster profile and more damping.
+  const TurnGains* gains = &turnSchedule[turnScheduleSize - 1];
+  for (int i = 0; i < turnScheduleSize; i++) {
+    if (fabsf(turnAngle) <= turnSchedule[i].maxAngle) {
+      gains = &turnSchedule[i];
+      break;
+    }
+  }
+  // Never plan a turn rate the voltage limit cannot reach, or the robot falls behind and overshoots.
+  float maxVelocity = gains->maxVelocity;
+  if (turnKv > 0) maxVelocity = fminf(maxVelocity, (turnMaxVoltage - turnKs) / turnKv);
+  ProfileSpec spec = {turnAngle, maxVelocity, gains->acceleration, 0, 0};
+  float duration = profileDuration(spec);
+
+  // The PID corrects the tracking error, so the timeout starts after the profile has ended.
+  PID turnPID(0, gains->kp, gains->ki, gains->kd, gains->starti, turnSettleError * earlyExitFactor, turnSettleTime / earlyExitFactor, turnTimeout + duration * 1000);
+  float progress = 0;
+  float previousVelocity = 0;
+  float time = 0;
+  float error = turnAngle;
+  // Follow the whole profile, then hold its end until the PID settles.
+  while ((time < duration || !turnPID.isDone()) && !robotState.drivetrainNeedsStopped) {
+    if (chained && time >= duration && fabsf(error) < turnSettleError) break;
+    time += PROFILE_DT;
+    ProfileSample target = profileAt(spec, fminf(time, duration));
+    // Unwrap the angle turned so far, so a 180 degree turn does not jump a full turn at the wrap.
+    float turned = turnAngle - wrap180(heading - getHeading());
+    progress = turned + 360.0f * roundf((progress - turned) * (1.0f / 360.0f));
+    error = target.position - progress;
+
+    float acceleration = (target.velocity - previousVelocity) / PROFILE_DT;
+    previousVelocity = target.velocity;
+    float output = turnPID.compute(error) + turnKv * target.velocity + turnKa * acceleration;
+    // Static friction is only overcome while the robot should be moving, so it does not dither once settled.
+    if (target.velocity != 0 || fabsf(error) > turnSettleError) output += output > 0 ? turnKs : -turnKs;
+    output = clampf(output, -turnMaxVoltage, turnMaxVoltage);
+    driveWithVoltage(output, -output);
+    waitTick();
+  }
+  if (earlyExitFactor == 1 && !chained)
+  {
+    stopMotors(hold);
+  }
+}
+
+void Drive::swingToHeading(float heading, swingSide side) {
+  swingToHeading(heading, side, swingMaxVoltage);
+}
+
+void Drive::swingToHeading(float heading, swingSide side, float swingMaxVoltage, float earlyExitFactor) {
+  if (earlyExitFactor > 5) earlyExitFactor = 5;
+  if (earlyExitFactor < 1) earlyExitFactor = 1;
+  robotState.desiredHeading = wrap360(heading);
+  PID swingPID(wrap180(heading - getHeading()), swingKp, swingKi, swingKd, swingStarti, swingSettleError * earlyExitFactor, swingSettleTime / earlyExitFactor, swingTimeout);
+  while (!swingPID.isDone() && !robotState.drivetrainNeedsStopped) {
+    float error = wrap180(heading - getHeading());
+    float output = swingPID.compute(error);
+    // A single side stalls on static friction well before the error settles, so push through it.
+    if (fabsf(error) > swingSettleError) output += output > 0 ? turnKs : -turnKs;
+    output = clampf(output, -swingMaxVoltage, swingMaxVoltage);
+    // Turning right, the left side drives forward or the right side drives backward.
+    swingWithVoltage(side, side == SWING_LEFT ? output : -output);
+    waitTick();
   }
   if (earlyExitFactor == 1)
   {
-    leftDrive.stop(hold);
-    rightDrive.stop(hold);
+    stopMotors(hold);
   }
 }
 
+void Drive::driveArc(float radius, float angle) {
+  driveArc(radius, angle, driveMaxVoltage);
+}
+
+void Drive::driveArc(float radius, float angle, float driveMaxVoltage, float earlyExitFactor) {
+  if (earlyExitFactor > 5) earlyExitFactor = 5;
+  if (earlyExitFactor < 1) earlyExitFactor = 1;
+  float startHeading = robotState.desiredHeading;
+  float angleRad = angle * (float)M_PI / 180.0f;
+  float arcLength = fabsf(radius * angleRad) * (radius < 0 ? -1 : 1);
+  if (arcLength == 0) {
+    turnToHeading(startHeading + angle, turnMaxVoltage, earlyExitFactor);
+    return;
+  }
+  robotState.desiredHeading = wrap360(startHeading + angle);
+  // The share of the drive voltage the outer side gains and the inner side loses to follow the curve.
+  float curvature = trackWidth * 0.5f * angleRad / arcLength;
+
+  PID drivePID(arcLength, driveKp, driveKi, driveKd, driveStarti, arcSettleError * earlyExitFactor, arcSettleTime / earlyExitFactor, arcTimeout);
+  PID headingPID(wrap180(startHeading - getHeading()), headingKp, headingKd);
+  float startAveragePosition = (getLeftPositionIn() + getRightPositionIn()) * 0.5f;
+  while (!drivePID.isDone() && !robotState.drivetrainNeedsStopped) {
+    float traveled = (getLeftPositionIn() + getRightPositionIn()) * 0.5f - startAveragePosition;
+    float driveError = arcLength - traveled;
+    // The desired heading follows the distance along the arc, so the heading PID only corrects drift from the curve.
+    float progress = clampf(traveled / arcLength, 0.0f, 1.0f);
+    float headingError = wrap180(startHeading + angle * progress - getHeading());
+    float driveOutput = clampf(drivePID.compute(driveError), -driveMaxVoltage, driveMaxVoltage);
+    float headingOutput = clampf(headingPID.compute(headingError), -headingMaxVoltage, headingMaxVoltage);
+
+    float leftOutput = driveOutput * (1 + curvature) + headingOutput;
+    float rightOutput = driveOutput * (1 - curvature) - headingOutput;
+    // Scale both sides down together, so the curve keeps its radius at the voltage limit.
+    float largest = fmaxf(fabsf(leftOutput), fabsf(rightOutput));
+    if (largest > driveMaxVoltage) {
+      leftOutput *= driveMaxVoltage / largest;
+      rightOutput *= driveMaxVoltage / largest;
+    }
+    driveWithVoltage(leftOutput, rightOutput);
+    waitTick();
+  }
+  if (earlyExitFactor == 1)
+  {
+    stopMotors(hold);
+  }
+}
+
+void Drive::driveChain(const ChainSegment* segments, int segmentCount) {
+  if (segmentCount > MAX_CHAIN_SEGMENTS) segmentCount = MAX_CHAIN_SEGMENTS;
+  if (segmentCount <= 0) return;
+
+  // Plan the speed at the end of each segment. Only drives in the same direction keep moving
+  // through a junction, and sharper heading changes take it slower.
+  float junctionVelocity[MAX_CHAIN_SEGMENTS];
+  for (int i = 0; i < segmentCount; i++) {
+    junctionVelocity[i] = 0;
+    if (i == segmentCount - 1) break;
+    const ChainSegment& segment = segments[i];
+    const ChainSegment& next = segments[i + 1];
+    if (segment.motion != CHAIN_DRIVE || next.motion != CHAIN_DRIVE) continue;
+    if ((segment.target < 0) != (next.target < 0)) continue;
+    float corner = clampf(1.0f - fabsf(wrap180(next.heading - segment.heading)) / chainCornerAngle, 0.0f, 1.0f);
+    junctionVelocity[i] = fminf(fabsf(segment.maxVelocity), fabsf(next.maxVelocity)) * corner;
+  }
+  // Each junction must be slow enough to reach the next junction's speed within the next segment,
+  // and no faster than the segment can reach from the previous junction.
+  for (int i = segmentCount - 2; i >= 0; i--) {
+    const ChainSegment& next = segments[i + 1];
+    float reachable = sqrtf(junctionVelocity[i + 1] * junctionVelocity[i + 1] + 2 * fabsf(next.acceleration * next.target));
+    junctionVelocity[i] = fminf(junctionVelocity[i], reachable);
+  }
+  float entryVelocity = 0;
+  for (int i = 0; i < segmentCount; i++) {
+    if (segments[i].motion == CHAIN_DRIVE) {
+      float reachable = sqrtf(entryVelocity * entryVelocity + 2 * fabsf(segments[i].acceleration * segments[i].target));
+      junctionVelocity[i] = fminf(junctionVelocity[i], reachable);
+    }
+    entryVelocity = junctionVelocity[i];
+  }
+
+  // Turns in place leave the average position alone, so one planned position runs through the whole chain.
+  float plannedPosition = (getLeftPositionIn() + getRightPositionIn()) * 0.5f;
+  float previousHeading = robotState.desiredHeading;
+  float previousError = 0;
+  entryVelocity = 0;
+  for (int i = 0; i < segmentCount && !robotState.drivetrainNeedsStopped; i++) {
+    const ChainSegment& segment = segments[i];
+    bool chained = i < segmentCount - 1;
+    if (segment.motion == CHAIN_TURN) {
+      if (turnScheduleSize > 0) {
+        turnProfiled(segment.target, turnMaxVoltage, 1, chained);
+      } else {
+        turnToHeading(segment.target, turnMaxVoltage, chained ? 5 : 1);
+      }
+      previousHeading = segment.target;
+    } else {
+      ProfileSpec spec = {segment.target, segment.maxVelocity, segment.acceleration, entryVelocity, junctionVelocity[i]};
+      plannedPosition = driveChainSegment(spec, previousHeading, segment.heading, plannedPosition, previousError, chained);
+      previousHeading = segment.heading;
+    }
+    entryVelocity = junctionVelocity[i];
+  }
+}
+
+float Drive::driveChainSegment(const ProfileSpec& spec, float startHeading, float endHeading, float startPosition, float& previousError, bool chained)
+{
+  robotState.desiredHeading = wrap360(endHeading);
+  float headingChange = wrap180(endHeading - startHeading);
+  float blendDistance = fminf(chainBlendDistance, fabsf(spec.distance) * 0.5f);
+  float duration = profileDuration(spec);
+
+  // The PID corrects the tracking error, so the timeout starts after the profile has ended.
+  PID drivePID(previousError, driveKp, driveKi, driveKd, driveStarti, driveSettleError, driveSettleTime, driveTimeout + duration * 1000);
+  drivePID.setPreviousError(previousError);
+  PID headingPID(wrap180(startHeading - getHeading()), headingKp, headingKd);
+  headingPID.setPreviousError(wrap180(startHeading - getHeading()));
+  float previousVelocity = spec.startVelocity * (spec.distance < 0 ? -1 : 1);
+  float time = 0;
+  float driveError = previousError;
+  // Follow the whole profile. The last segment then holds its end until the PID settles; a chained
+  // segment hands over at once if it is still moving, or once it is inside the settle error.
+  while ((time < duration || !drivePID.isDone()) && !robotState.drivetrainNeedsStopped) {
+    if (chained && time >= duration && (spec.endVelocity != 0 || fabsf(driveError) < driveSettleError)) break;
+    time += PROFILE_DT;
+    ProfileSample target = profileAt(spec, fminf(time, duration));
+    float averagePosition = (getLeftPositionIn() + getRightPositionIn()) * 0.5f;
+    driveError = target.position + startPosition - averagePosition;
+    float blend = blendDistance > 0 ? clampf(fabsf(target.position) / blendDistance, 0.0f, 1.0f) : 1.0f;
+    float headingError = wrap180(startHeading + headingChange * blend - getHeading());
+
+    float acceleration = (target.velocity - previousVelocity) / PROFILE_DT;
+    previousVelocity = target.velocity;
+    float feedforward = driveKv * target.velocity + driveKa * acceleration;
+    if (target.velocity != 0) feedforward += target.velocity > 0 ? driveKs : -driveKs;
+    float driveOutput = drivePID.compute(driveError) + feedforward;
+    float headingOutput = headingPID.compute(headingError);
+
+    driveOutput = clampf(driveOutput, -driveMaxVoltage, driveMaxVoltage);
+    headingOutput = clampf(headingOutput, -headingMaxVoltage, headingMaxVoltage);
+
+    driveWithVoltage(driveOutput + headingOutput, driveOutput - headingOutput);
+    waitTick();
+  }
+  previousError = driveError;
+  if (!chained)
+  {
+    stopMotors(hold);
+  }
+  return startPosition + spec.distance;
+}
+
 void Drive::driveDistance(float distance) {
-  driveDistance(distance, driveMaxVoltage, desiredHeading, headingMaxVoltage);
+  driveDistance(distance, driveMaxVoltage, robotState.desiredHeading, headingMaxVoltage);
 }
 
 void Drive::driveDistance(float distance, float driveMaxVoltage) {
-  driveDistance(distance, driveMaxVoltage, desiredHeading, headingMaxVoltage);
+  driveDistance(distance, driveMaxVoltage, robotState.desiredHeading, headingMaxVoltage);
 }
 
 void Drive::driveDistance(float distance, float driveMaxVoltage, float heading, float headingMaxVoltage,  float earlyExitFactor)
 {
   if (earlyExitFactor > 5) earlyExitFactor = 5;
   if (earlyExitFactor < 1) earlyExitFactor = 1;
-  desiredHeading = normalize360(heading);
+  robotState.desiredHeading = wrap360(heading);
   PID drivePID(distance, driveKp, driveKi, driveKd, driveStarti, driveSettleError * earlyExitFactor, driveSettleTime/earlyExitFactor, driveTimeout);
-  PID headingPID(normalize180(desiredHeading - getHeading()), headingKp, headingKd);
-  float startAveragePosition = (getLeftPositionIn() + getRightPositionIn()) / 2.0;
+  PID headingPID(wrap180(robotState.desiredHeading - getHeading()), headingKp, headingKd);
+  float startAveragePosition = (getLeftPositionIn() + getRightPositionIn()) * 0.5f;
   float averagePosition = startAveragePosition;
-  while (drivePID.isDone() == false && !drivetrainNeedsStopped) {
-    averagePosition = (getLeftPositionIn() + getRightPositionIn()) / 2.0;
+  while (drivePID.isDone() == false && !robotState.drivetrainNeedsStopped) {
+    averagePosition = (getLeftPositionIn() + getRightPositionIn()) * 0.5f;
     float driveError = distance + startAveragePosition - averagePosition;
-    float headingError = normalize180(desiredHeading - getHeading());
+    float headingError = wrap180(robotState.desiredHeading - getHeading());
     float driveOutput = drivePID.compute(driveError);
     float headingOutput = headingPID.compute(headingError);
 
-    driveOutput = threshold(driveOutput, -driveMaxVoltage, driveMaxVoltage);
-    headingOutput = threshold(headingOutput, -headingMaxVoltage, headingMaxVoltage);
+    driveOutput = clampf(driveOutput, -driveMaxVoltage, driveMaxVoltage);
+    headingOutput = clampf(headingOutput, -headingMaxVoltage, headingMaxVoltage);
 
     driveWithVoltage(driveOutput + headingOutput, driveOutput - headingOutput);
-    wait(10, msec);
+    waitTick();
   }
   if (earlyExitFactor == 1)
   {
-    leftDrive.stop(hold);
-    rightDrive.stop(hold);
+    stopMotors(hold);
+  }
+}
+
+
+void Drive::driveProfile(const ProfileSpec& spec)
+{
+  driveProfile(spec, driveMaxVoltage);
+}
+
+void Drive::driveProfile(const ProfileSpec& spec, float driveMaxVoltage)
+{
+  int sampleCount = 0;
+  const ProfileSample* samples = trajectoryCache.get(spec, sampleCount);
+  if (samples == nullptr) {
+    // The cache is full, so drive without a profile.
+    driveDistance(spec.distance, driveMaxVoltage);
+    return;
+  }
+  // The PID corrects the tracking error, so the timeout starts after the profile has ended.
+  PID drivePID(spec.distance, driveKp, driveKi, driveKd, driveStarti, driveSettleError, driveSettleTime, driveTimeout + sampleCount * 10);
+  PID headingPID(wrap180(robotState.desiredHeading - getHeading()), headingKp, headingKd);
+  float startAveragePosition = (getLeftPositionIn() + getRightPositionIn()) * 0.5f;
+  float previousVelocity = spec.startVelocity;
+  int tick = 0;
+  // Follow the whole profile, then hold its end until the PID settles.
+  while ((tick < sampleCount || !drivePID.isDone()) && !robotState.drivetrainNeedsStopped) {
+    const ProfileSample& target = samples[tick < sampleCount ? tick : sampleCount - 1];
+    float averagePosition = (getLeftPositionIn() + getRightPositionIn()) * 0.5f;
+    float driveError = target.position + startAveragePosition - averagePosition;
+    float headingError = wrap180(robotState.desiredHeading - getHeading());
+
+    float acceleration = (target.velocity - previousVelocity) / PROFILE_DT;
+    previousVelocity = target.velocity;
+    float feedforward = driveKv * target.velocity + driveKa * acceleration;
+    if (target.velocity != 0) feedforward += target.velocity > 0 ? driveKs : -driveKs;
+    float driveOutput = drivePID.compute(driveError) + feedforward;
+    float headingOutput = headingPID.compute(headingError);
+
+    driveOutput = clampf(driveOutput, -driveMaxVoltage, driveMaxVoltage);
+    headingOutput = clampf(headingOutput, -headingMaxVoltage, headingMaxVoltage);
+
+    driveWithVoltage(driveOutput + headingOutput, driveOutput - headingOutput);
+    if (tick < sampleCount) tick++;
+    waitTick();
+  }
+  trajectoryCache.release();
+  if (spec.endVelocity == 0)
+  {
+    stopMotors(hold);
   }
 }
 
+void Drive::setActiveBrake(float kBrakeDamping, float kBrakeFullSpeed, float activeBrakeTime)
+{
+  this->kBrakeDamping = kBrakeDamping;
+  this->kBrakeFullSpeed = kBrakeFullSpeed;
+  this->activeBrakeTime = activeBrakeTime;
+}
+
+void Drive::startActiveBrake()
+{
+  float leftVelocity = getLeftVelocityIn();
+  float rightVelocity = getRightVelocityIn();
+  float releaseSpeed = fmaxf(fabsf(leftVelocity), fabsf(rightVelocity));
+  brakeScale = clampf(releaseSpeed / kBrakeFullSpeed, kBrakeMinScale, 1);
+  brakeLeftLatched = false;
+  brakeRightLatched = false;
+  brakeEndTime = getControlTime() + activeBrakeTime;
+  braking = true;
+}
+
+float Drive::brakeOutput(float position, float velocity, float& target, bool& latched)
+{
+  // Until the side slows below 2 inch/sec, the target follows it, so only the damping acts and the
+  // robot is not pulled back to where the sticks were released.
+  if (!latched) {
+    target = position;
+    if (fabsf(velocity) < 2) latched = true;
+  }
+  return clampf(brakeScale * (kBrake * (target - position) - kBrakeDamping * velocity), -12, 12);
+}
 
-double curveFunction(double x, double curveScale) {
-  return (powf(2.718, -(curveScale / 10)) + powf(2.718, (fabs(x) - 100) / 10) * (1 - powf(2.718, -(curveScale / 10)))) * x;
+void Drive::updateActiveBrake()
+{
+  if (getControlTime() >= brakeEndTime) {
+    stopSides(stopMode);
+    braking = false;
+    return;
+  }
+  float leftVelocity = getLeftVelocityIn();
+  float rightVelocity = getRightVelocityIn();
+  float leftOutput = brakeOutput(getLeftPositionIn(), leftVelocity, brakeLeftTarget, brakeLeftLatched);
+  float rightOutput = brakeOutput(getRightPositionIn(), rightVelocity, brakeRightTarget, brakeRightLatched);
+  // Braking is a deceleration like any other, so it stays within the drive limits and the tip correction.
+  float tipCorrection = getTipCorrection();
+  driveSides(limitAcceleration(leftOutput, leftVelocity, tipCorrection), limitAcceleration(rightOutput, rightVelocity, tipCorrection));
+}
+
+void Drive::setDriveLimits(const DriveLimits& driveLimits)
+{
+  this->driveLimits = driveLimits;
+}
+
+float Drive::getTipCorrection()
+{
+  if (driveLimits.tipAngle <= 0) return 0;
+  float pitch = gyro.pitch();
+  if (fabsf(pitch) <= driveLimits.tipAngle) return 0;
+  // Front up: accelerate backwards to bring the wheels back under the robot. Front down: forwards.
+  return -driveLimits.tipGain * (pitch - (pitch > 0 ? driveLimits.tipAngle : -driveLimits.tipAngle));
+}
+
+float Drive::getTurnScale()
+{
+  if (driveLimits.tipAngle <= 0) return 1;
+  float roll = fabsf(gyro.roll());
+  // Turning at speed rolls the robot outwards, so give up the turn until it is back under the tip angle.
+  return clampf(2 - roll / driveLimits.tipAngle, 0, 1);
+}
+
+float Drive::getWheelVelocity(motor& wheel)
+{
+  return wheel.velocity(dps) * driveInToDegRatio;
+}
+
+float Drive::getLeftVelocityIn()
+{
+  if (simulation) return simulation->getLeftVelocity();
+  return leftDrive.velocity(dps) * driveInToDegRatio;
+}
+
+float Drive::getRightVelocityIn()
+{
+  if (simulation) return simulation->getRightVelocity();
+  return rightDrive.velocity(dps) * driveInToDegRatio;
+}
+
+float Drive::getControlTime()
+{
+  if (simulation) return simulation->getTicks() * 10;
+  return timer::system();
+}
+
+void Drive::driveSides(float leftVoltage, float rightVoltage)
+{
+  if (simulation) {
+    simulation->setVoltage(leftVoltage, rightVoltage);
+    return;
+  }
+  leftDrive.spin(fwd, leftVoltage, volt);
+  rightDrive.spin(fwd, rightVoltage, volt);
+}
+
+void Drive::stopSides(vex::brakeType mode)
+{
+  if (simulation) {
+    simulation->stop(mode);
+    return;
+  }
+  leftDrive.stop(mode);
+  rightDrive.stop(mode);
+}
+
+float Drive::limitAcceleration(float voltage, float velocity, float tipCorrection)
+{
+  // The voltage that holds the current speed. Only the difference from it accelerates the wheel.
+  float holdVoltage = driveKv * velocity;
+  float accelVoltage = voltage - holdVoltage;
+  bool speedingUp = accelVoltage * velocity >= 0;
+  float limit = speedingUp ? driveLimits.maxAccelVoltage : driveLimits.maxDecelVoltage;
+  accelVoltage = clampf(accelVoltage, -limit, limit);
+  if (tipCorrection < 0) accelVoltage = fminf(accelVoltage, tipCorrection);
+  if (tipCorrection > 0) accelVoltage = fmaxf(accelVoltage, tipCorrection);
+  return clampf(holdVoltage + accelVoltage, -12, 12);
 }
 
 void Drive::setArcadeConstants(float kBrake, float kTurnBias, float kTurnDampingFactor)
@@ -138,113 +672,131 @@ void Drive::setArcadeConstants(float kBrake, float kTurnBias, float kTurnDamping
 }
 
 void Drive::controlArcade(int y, int x) {
-  float throttle = deadband(y, 5);
-  float turn = deadband(x, 5) * kTurnDampingFactor;
+  float throttle = deadbandf(y, 5);
+  float turn = deadbandf(x, 5) * kTurnDampingFactor;
 
-  turn = curveFunction(turn, kTurn);
-  throttle = curveFunction(throttle, kThrottle);
+  turn = curve(turn, turnCurveMin) * getTurnScale();
+  throttle = curve(throttle, throttleCurveMin);
 
-  float leftPower = toVolt(throttle + turn);
-  float rightPower = toVolt(throttle - turn);
+  float leftPower = percentToVolt(throttle + turn);
+  float rightPower = percentToVolt(throttle - turn);
 
   if (kTurnBias > 0) {
-    if (fabs(throttle) + fabs(turn) > 100) {
+    if (fabsf(throttle) + fabsf(turn) > 100) {
       int oldThrottle = throttle;
       int oldTurn = turn;
-      throttle *= (1 - kTurnBias * fabs(oldTurn / 100.0));
-      turn *= (1 - (1 - kTurnBias) * fabs(oldThrottle / 100.0));
+      throttle *= (1 - kTurnBias * fabsf(oldTurn / 100.0f));
+      turn *= (1 - (1 - kTurnBias) * fabsf(oldThrottle / 100.0f));
     }
-    leftPower = toVolt(throttle + turn);
-    rightPower = toVolt(throttle - turn);
+    leftPower = percentToVolt(throttle + turn);
+    rightPower = percentToVolt(throttle - turn);
   }
 
-  if (fabs(throttle) > 0 || fabs(turn) > 0) {
-    leftDrive.spin(fwd, leftPower, volt);
-    rightDrive.spin(fwd, rightPower, volt);
-    drivetrainNeedsStopped = true;
+  if (fabsf(throttle) > 0 || fabsf(turn) > 0) {
+    float tipCorrection = getTipCorrection();
+    driveSides(limitAcceleration(leftPower, getLeftVelocityIn(), tipCorrection),
+               limitAcceleration(rightPower, getRightVelocityIn(), tipCorrection));
+    robotState.drivetrainNeedsStopped = true;
+    braking = false;
   }
   // When joystick are released, run active brake on drive
-  // ajdust the coefficient to the amount of coasting preferred
+  // ajdust the coefficients in setArcadeConstants and setActiveBrake to the amount of coasting preferred
   else {
-    if (drivetrainNeedsStopped) {
+    if (robotState.drivetrainNeedsStopped) {
       if (stopMode != hold) {
-        leftDrive.resetPosition();
-        rightDrive.resetPosition();
-        wait(20, msec);
-        leftDrive.spin(fwd, -leftDrive.position(rev) * kBrake, volt);
-        rightDrive.spin(fwd, -rightDrive.position(rev) * kBrake, volt);
+        startActiveBrake();
       } else {
-        leftDrive.stop(hold);
-        rightDrive.stop(hold);
+        stopSides(hold);
       }
-      drivetrainNeedsStopped = false;
+      robotState.drivetrainNeedsStopped = false;
     }
+    if (braking) updateActiveBrake();
   }
 }
 
 void Drive::controlTank(int left, int right) {
-  float leftthrottle = curveFunction(left, kThrottle);
-  float rightthrottle = curveFunction(right, kThrottle);
-
-  if (fabs(leftthrottle) > 0 || fabs(rightthrottle) > 0) {
-    leftDrive.spin(fwd, toVolt(leftthrottle), volt);
-    rightDrive.spin(fwd, toVolt(rightthrottle), volt);
-    drivetrainNeedsStopped = true;
+  float leftthrottle = curve(left, throttleCurveMin);
+  float rightthrottle = curve(right, throttleCurveMin);
+
+  if (fabsf(leftthrottle) > 0 || fabsf(rightthrottle) > 0) {
+    // Scale the difference between the sides, which is the turn, when the robot rolls.
+    float forward = (leftthrottle + rightthrottle) * 0.5f;
+    float turn = (leftthrottle - rightthrottle) * 0.5f * getTurnScale();
+    float tipCorrection = getTipCorrection();
+    driveSides(limitAcceleration(percentToVolt(forward + turn), getLeftVelocityIn(), tipCorrection),
+               limitAcceleration(percentToVolt(forward - turn), getRightVelocityIn(), tipCorrection));
+    robotState.drivetrainNeedsStopped = true;
   } else {
-    if (drivetrainNeedsStopped) {
-      leftDrive.stop(stopMode);
-      rightDrive.stop(stopMode);
-      drivetrainNeedsStopped = false;
+    if (robotState.drivetrainNeedsStopped) {
+      stopSides(stopMode);
+      robotState.drivetrainNeedsStopped = false;
     }
   }
 }
 
-void Drive::controlMecanum(int x, int y, int acc, int steer, motor DriveLF, motor DriveRF, motor DriveLB, motor DriveRB) {
-  float throttle = deadband(y, 5);
-  float strafe = deadband(x, 5);
-  float straight = deadband(acc, 5);
-  float turn = deadband(steer, 5);
-  straight = curveFunction(straight, kThrottle);
-  turn = curveFunction(turn, kTurn);
+void Drive::controlMecanum(int x, int y, int acc, int steer, motor& driveLF, motor& driveRF, motor& driveLB, motor& driveRB) {
+  float throttle = deadbandf(y, 5);
+  float strafe = deadbandf(x, 5);
+  float straight = deadbandf(acc, 5);
+  float turn = deadbandf(steer, 5);
+  straight = curve(straight, throttleCurveMin);
+  turn = curve(turn, turnCurveMin) * getTurnScale();
 
   if (turn == 0 && strafe == 0 && throttle == 0 && straight == 0) {
-    if (drivetrainNeedsStopped) {
-      leftDrive.stop(stopMode);
-      rightDrive.stop(stopMode);
-      drivetrainNeedsStopped = false;
-      return;
+    if (robotState.drivetrainNeedsStopped) {
+      driveLF.stop(stopMode);
+      driveRF.stop(stopMode);
+      driveLB.stop(stopMode);
+      driveRB.stop(stopMode);
+      robotState.drivetrainNeedsStopped = false;
     }
-  } 
-
-  if (turn == 0 && straight == 0) {
-    DriveLF.spin(fwd, toVolt(throttle + turn + strafe), volt);
-    DriveRF.spin(fwd, toVolt(throttle - turn - strafe), volt);
-    DriveLB.spin(fwd, toVolt(throttle + turn - strafe), volt);
-    DriveRB.spin(fwd, toVolt(throttle - turn + strafe), volt);
+    return;
   }
-  //aracade drive
-  else
-  {
-    float leftPower = toVolt(throttle + turn);
-    float rightPower = toVolt(throttle - turn);
-    leftDrive.spin(fwd, leftPower, volt);
-    rightDrive.spin(fwd, rightPower, volt);
-    drivetrainNeedsStopped = true;
+
+  // Either forward axis drives forward. Scale all wheels down together if any is over 100%.
+  float forward = throttle + straight;
+  float powerLF = forward + turn + strafe;
+  float powerRF = forward - turn - strafe;
+  float powerLB = forward + turn - strafe;
+  float powerRB = forward - turn + strafe;
+  float maxPower = fmaxf(fmaxf(fabsf(powerLF), fabsf(powerRF)), fmaxf(fabsf(powerLB), fabsf(powerRB)));
+  if (maxPower > 100) {
+    float scale = 100 / maxPower;
+    powerLF *= scale;
+    powerRF *= scale;
+    powerLB *= scale;
+    powerRB *= scale;
   }
+  float tipCorrection = getTipCorrection();
+  driveLF.spin(fwd, limitAcceleration(percentToVolt(powerLF), getWheelVelocity(driveLF), tipCorrection), volt);
+  driveRF.spin(fwd, limitAcceleration(percentToVolt(powerRF), getWheelVelocity(driveRF), tipCorrection), volt);
+  driveLB.spin(fwd, limitAcceleration(percentToVolt(powerLB), getWheelVelocity(driveLB), tipCorrection), volt);
+  driveRB.spin(fwd, limitAcceleration(percentToVolt(powerRB), getWheelVelocity(driveRB), tipCorrection), volt);
+  robotState.drivetrainNeedsStopped = true;
 }
 
 void Drive::stop(vex::brakeType mode) {
-    drivetrainNeedsStopped = true;
+  if (motionLog.isReplaying()) return;
+  if (simulation) {
+    simulation->stop(mode);
+    simulation->resetPosition();
+    stopMode = mode;
+    return;
+  }
+  // A source that does not hold the drivetrain must not cancel or reset the motion of the one that does.
+  if (chassisArbiter.allowCommand(chassisArbiter.getThreadSource())) {
+    robotState.drivetrainNeedsStopped = true;
     leftDrive.stop(mode);
     rightDrive.stop(mode);
     stopMode = mode;
     leftDrive.resetPosition();
     rightDrive.resetPosition();
-    drivetrainNeedsStopped = false;
+    robotState.drivetrainNeedsStopped = false;
+  }
 }
 
 void Drive::checkStatus(){
-  int distanceTraveled = (getLeftPositionIn() + getRightPositionIn()) / 2.0;
+  int distanceTraveled = getDistanceTraveled();
     // Display heading and the distance traveled previously on the controller screen.
   int h = chassis.getHeading();
   char statusMsg[50];
@@ -0,0 +1,41 @@
+#include "vex.h"
+
+LatencyStats::LatencyStats(float binWidth) :
+  binWidth(binWidth) {
+  reset();
+}
+
+void LatencyStats::record(float latency) {
+  int bin = latency / binWidth;
+  if (bin < 0) bin = 0;
+  if (bin >= BIN_COUNT) bin = BIN_COUNT - 1;
+  bins[bin]++;
+  count++;
+  if (latency > maxLatency) maxLatency = latency;
+}
+
+float LatencyStats::percentile(float percent) {
+  if (count == 0) return 0;
+  int target = ceil(count * percent / 100.0);
+  int seen = 0;
+  for (int i = 0; i < BIN_COUNT; i++) {
+    seen += bins[i];
+    // Report the upper edge of the bin, so the result is never optimistic.
+    if (seen >= target) return fmin((i + 1) * binWidth, maxLatency);
+  }
+  return maxLatency;
+}
+
+float LatencyStats::getMax() {
+  return maxLatency;
+}
+
+int LatencyStats::getCount() {
+  return count;
+}
+
+void LatencyStats::reset() {
+  for (int i = 0; i < BIN_COUNT; i++) bins[i] = 0;
+  count = 0;
+  maxLatency = 0;
+}
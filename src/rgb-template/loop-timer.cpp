@@ -0,0 +1,49 @@
+#include "vex.h"
+
+LoopTimer::LoopTimer(uint32_t period) :
+  period(period) {}
+
+void LoopTimer::setPeriod(uint32_t period) {
+  this -> period = period;
+}
+
+uint32_t LoopTimer::getPeriod() {
+  return period;
+}
+
+void LoopTimer::start() {
+  nextTick = timer::system();
+}
+
+void LoopTimer::waitForNextTick() {
+  nextTick += period;
+  uint32_t now = timer::system();
+  if ((int32_t)(nextTick - now) <= 0) {
+    // The loop body overran the period: start a new schedule instead of trying to catch up.
+    overruns++;
+    nextTick = now;
+    this_thread::yield();
+  } else {
+    this_thread::sleep_until(nextTick);
+  }
+  jitter = timer::systemHighResolution() - (uint64_t)nextTick * 1000;
+  if (jitter > maxJitter) maxJitter = jitter;
+}
+
+float LoopTimer::getJitter() {
+  return jitter;
+}
+
+float LoopTimer::getMaxJitter() {
+  return maxJitter;
+}
+
+int LoopTimer::getOverruns() {
+  return overruns;
+}
+
+void LoopTimer::resetStats() {
+  jitter = 0;
+  maxJitter = 0;
+  overruns = 0;
+}
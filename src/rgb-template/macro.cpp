@@ -0,0 +1,70 @@
+#include "vex.h"
+
+MacroRunner::MacroRunner() :
+  cancelled(false) {}
+
+bool MacroRunner::start(const MacroStep* steps, int stepCount, void (*onCancel)()) {
+  if (robotState.macroRunning) return false;
+  if (chassisArbiter.getWinner() > OWNER_MACRO) return false;
+  this -> steps = steps;
+  this -> stepCount = stepCount;
+  this -> onCancel = onCancel;
+  cancelled = false;
+  robotState.macroRunning = true;
+  robotState.drivetrainNeedsStopped = false;
+  chassisArbiter.claim(OWNER_MACRO);
+  thread macroThread = thread(macroTask, this);
+  return true;
+}
+
+int MacroRunner::macroTask(void* runner) {
+  MacroRunner* macro = static_cast<MacroRunner*>(runner);
+  // An unbound macro would drive as the driver, so it does not run at all.
+  if (!chassisArbiter.bindThread(OWNER_MACRO)) macro->cancelled = true;
+  int i = 0;
+  for (; i < macro->stepCount && !macro->cancelled; i++) {
+    if (!macro->steps[i].run(macro->steps[i].value)) break;
+  }
+  // The step in progress has returned, so the cleanup cannot be undone by it.
+  if (i < macro->stepCount && macro->onCancel) macro->onCancel();
+  chassisArbiter.release(OWNER_MACRO);
+  chassisArbiter.unbindThread();
+  robotState.macroRunning = false;
+  return 0;
+}
+
+void MacroRunner::cancel() {
+  if (!robotState.macroRunning) return;
+  cancelled = true;
+  // Makes the current turnToHeading or driveDistance exit on its next iteration.
+  robotState.drivetrainNeedsStopped = true;
+  // Hands the drivetrain back right away, so a late command from the macro cannot reach the motors.
+  chassisArbiter.release(OWNER_MACRO);
+}
+
+bool MacroRunner::isRunning() {
+  return robotState.macroRunning;
+}
+
+bool MacroRunner::isCancelled() {
+  return cancelled;
+}
+
+bool macroTurnToHeading(float heading) {
+  chassis.turnToHeading(heading);
+  return !macroRunner.isCancelled();
+}
+
+bool macroDriveDistance(float distance) {
+  chassis.driveDistance(distance);
+  return !macroRunner.isCancelled();
+}
+
+bool macroWait(float time) {
+  float endTime = timer::system() + time;
+  while (timer::system() < endTime) {
+    if (macroRunner.isCancelled()) return false;
+    wait(10, msec);
+  }
+  return true;
+}
@@ -0,0 +1,86 @@
+#include "vex.h"
+
+MatchScheduler MatchScheduler::onlyInstance;
+
+MatchScheduler::MatchScheduler() :
+  running(false),
+  taskStarted(false) {}
+
+MatchScheduler& MatchScheduler::instance() {
+  return onlyInstance;
+}
+
+bool MatchScheduler::schedule(uint32_t time, matchEventFunction run, uint32_t interval) {
+  eventLock.lock();
+  bool added = eventCount < MAX_EVENTS;
+  if (added) {
+    MatchEvent event = {run, time, interval, time, false};
+    events[eventCount++] = event;
+  }
+  eventLock.unlock();
+  return added;
+}
+
+void MatchScheduler::start() {
+  eventLock.lock();
+  for (int i = 0; i < eventCount; i++) {
+    events[i].nextTime = events[i].time;
+    events[i].done = false;
+  }
+  startTime = timer::systemHighResolution();
+  running = true;
+  eventLock.unlock();
+  // One task serves every match, however many times driver control starts.
+  if (taskStarted.exchange(true)) return;
+  thread schedulerThread = thread(schedulerTask, this);
+  // Timed aids must fire on time even while the control loops are busy.
+  schedulerThread.setPriority(thread::threadPriorityHigh);
+}
+
+void MatchScheduler::stop() {
+  running = false;
+}
+
+uint32_t MatchScheduler::getMatchTime() {
+  return (timer::systemHighResolution() - startTime) / 1000;
+}
+
+int MatchScheduler::schedulerTask(void* scheduler) {
+  MatchScheduler* matchScheduler = static_cast<MatchScheduler*>(scheduler);
+  while (true) {
+    uint32_t sleepTime = matchScheduler->runDueEvents();
+    // Sleeping exactly until the next event keeps it within a tick of its time.
+    wait(sleepTime, msec);
+  }
+  return 0;
+}
+
+uint32_t MatchScheduler::runDueEvents() {
+  if (!running) return MAX_SLEEP;
+  uint32_t sleepTime = MAX_SLEEP;
+  for (int i = 0; i < MAX_EVENTS; i++) {
+    eventLock.lock();
+    if (i >= eventCount) {
+      eventLock.unlock();
+      break;
+    }
+    MatchEvent& event = events[i];
+    uint64_t now = timer::systemHighResolution() - startTime;
+    uint64_t due = (uint64_t)event.nextTime * 1000;
+    matchEventFunction run = nullptr;
+    if (!event.done && now >= due) {
+      run = event.run;
+      if (event.interval > 0) event.nextTime += event.interval;
+      else event.done = true;
+    }
+    if (!event.done) {
+      uint64_t nextDue = (uint64_t)event.nextTime * 1000;
+      uint32_t untilDue = nextDue > now ? (nextDue - now + 999) / 1000 : 1;
+      if (untilDue < sleepTime) sleepTime = untilDue;
+    }
+    eventLock.unlock();
+    // The action runs outside the lock, so it can schedule other events.
+    if (run) run();
+  }
+  return sleepTime;
+}
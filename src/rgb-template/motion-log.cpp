@@ -0,0 +1,139 @@
+#include "vex.h"
+
+// Identifies a motion log written by this version of the recorder.
+static const uint32_t MOTION_LOG_MAGIC = 0x4C4D4753;
+
+MotionLog::MotionLog() {
+  store.magic = MOTION_LOG_MAGIC;
+  store.autonSelection = -1;
+  store.sampleCount = 0;
+}
+
+void MotionLog::startRecording(int autonSelection) {
+  store.autonSelection = autonSelection;
+  store.sampleCount = 0;
+  recordingThread = this_thread::get_id();
+  reading.heading = 0;
+  reading.leftPosition = 0;
+  reading.rightPosition = 0;
+  reading.frontDistance = 0;
+  recording = true;
+}
+
+void MotionLog::stopRecording() {
+  recording = false;
+}
+
+bool MotionLog::isRecording() {
+  return recording;
+}
+
+bool MotionLog::isRecordingThread() {
+  return recording && this_thread::get_id() == recordingThread;
+}
+
+void MotionLog::noteHeading(float heading) {
+  if (isRecordingThread()) reading.heading = heading;
+}
+
+void MotionLog::noteLeftPosition(float leftPosition) {
+  if (isRecordingThread()) reading.leftPosition = leftPosition;
+}
+
+void MotionLog::noteRightPosition(float rightPosition) {
+  if (isRecordingThread()) reading.rightPosition = rightPosition;
+}
+
+void MotionLog::noteFrontDistance(float frontDistance) {
+  if (isRecordingThread()) reading.frontDistance = frontDistance;
+}
+
+void MotionLog::record(float leftVoltage, float rightVoltage) {
+  if (!isRecordingThread() || store.sampleCount >= MotionLogStore::MAX_SAMPLES) return;
+  MotionSample& sample = store.samples[store.sampleCount++];
+  sample.heading = reading.heading;
+  sample.leftPosition = reading.leftPosition;
+  sample.rightPosition = reading.rightPosition;
+  sample.leftVoltage = leftVoltage;
+  sample.rightVoltage = rightVoltage;
+  sample.frontDistance = reading.frontDistance;
+}
+
+bool MotionLog::save(const char* fileName) {
+  if (!Brain.SDcard.isInserted()) return false;
+  int size = sizeof(MotionLogStore) - sizeof(store.samples) + store.sampleCount * sizeof(MotionSample);
+  return Brain.SDcard.savefile(fileName, (uint8_t*)&store, size) == size;
+}
+
+bool MotionLog::load(const char* fileName) {
+  if (!Brain.SDcard.isInserted() || !Brain.SDcard.exists(fileName)) return false;
+  int headerSize = sizeof(MotionLogStore) - sizeof(store.samples);
+  int size = Brain.SDcard.loadfile(fileName, (uint8_t*)&store, sizeof(store));
+  bool valid = size >= headerSize && store.magic == MOTION_LOG_MAGIC && store.sampleCount >= 0
+    && store.sampleCount <= MotionLogStore::MAX_SAMPLES && size == headerSize + store.sampleCount * (int)sizeof(MotionSample);
+  if (!valid) {
+    store.magic = MOTION_LOG_MAGIC;
+    store.sampleCount = 0;
+  }
+  return valid;
+}
+
+int MotionLog::getAutonSelection() {
+  return store.autonSelection;
+}
+
+int MotionLog::getSampleCount() {
+  return store.sampleCount;
+}
+
+void MotionLog::startReplay() {
+  cursor = 0;
+  firstDivergence = -1;
+  maxDivergence = 0;
+  comparedCount = 0;
+  replaying = store.sampleCount > 0;
+}
+
+void MotionLog::stopReplay() {
+  replaying = false;
+}
+
+bool MotionLog::isReplaying() {
+  return replaying;
+}
+
+const MotionSample& MotionLog::current() {
+  return store.samples[cursor];
+}
+
+void MotionLog::compare(float leftVoltage, float rightVoltage) {
+  const MotionSample& sample = store.samples[cursor];
+  float divergence = fmaxf(fabsf(leftVoltage - sample.leftVoltage), fabsf(rightVoltage - sample.rightVoltage));
+  if (divergence > maxDivergence) maxDivergence = divergence;
+  if (divergence > divergenceThreshold && firstDivergence < 0) firstDivergence = cursor;
+  comparedCount++;
+}
+
+bool MotionLog::advance() {
+  if (cursor + 1 >= store.sampleCount) return false;
+  cursor++;
+  return true;
+}
+
+int MotionLog::getFirstDivergence() {
+  return firstDivergence;
+}
+
+float MotionLog::getMaxDivergence() {
+  return maxDivergence;
+}
+
+void MotionLog::printReport() {
+  char msg[30];
+  if (firstDivergence < 0) {
+    sprintf(msg, "%d ok max %.2fV", comparedCount, maxDivergence);
+  } else {
+    sprintf(msg, "div %.2fs max %.1fV", firstDivergence * 0.01, maxDivergence);
+  }
+  printControllerScreen(msg, MESSAGE_HIGH, 3000);
+}
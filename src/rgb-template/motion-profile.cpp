@@ -0,0 +1,103 @@
+#include "vex.h"
+
+// The phases of a trapezoidal profile, computed once per profile.
+struct ProfileShape
+{
+  float direction;
+  float startVelocity;
+  float peakVelocity;
+  float endVelocity;
+  float acceleration;
+  float accelTime;
+  float cruiseTime;
+  float decelTime;
+  float accelDistance;
+  float cruiseDistance;
+  float totalDistance;
+};
+
+static ProfileShape profileShape(const ProfileSpec& spec) {
+  ProfileShape shape;
+  shape.direction = spec.distance < 0 ? -1.0f : 1.0f;
+  shape.totalDistance = fabsf(spec.distance);
+  shape.acceleration = fmaxf(fabsf(spec.acceleration), 1.0f);
+  float maxVelocity = fmaxf(fabsf(spec.maxVelocity), 1.0f);
+  shape.startVelocity = fminf(fabsf(spec.startVelocity), maxVelocity);
+  shape.endVelocity = fminf(fabsf(spec.endVelocity), maxVelocity);
+
+  // The highest speed reachable when accelerating from the start speed and then decelerating
+  // to the end speed within the distance.
+  float a = shape.acceleration;
+  float reachable = sqrtf(fmaxf((2 * a * shape.totalDistance + shape.startVelocity * shape.startVelocity
+                                 + shape.endVelocity * shape.endVelocity) * 0.5f, 0.0f));
+  shape.peakVelocity = fminf(maxVelocity, reachable);
+  // If the distance is too short to change from the start speed to the end speed, the profile
+  // reaches the distance before the change is complete.
+  if (shape.peakVelocity < shape.startVelocity) shape.peakVelocity = shape.startVelocity;
+  if (shape.peakVelocity < shape.endVelocity) shape.peakVelocity = shape.endVelocity;
+
+  shape.accelTime = (shape.peakVelocity - shape.startVelocity) / a;
+  shape.decelTime = (shape.peakVelocity - shape.endVelocity) / a;
+  shape.accelDistance = (shape.startVelocity + shape.peakVelocity) * 0.5f * shape.accelTime;
+  float decelDistance = (shape.peakVelocity + shape.endVelocity) * 0.5f * shape.decelTime;
+  shape.cruiseDistance = fmaxf(shape.totalDistance - shape.accelDistance - decelDistance, 0.0f);
+  shape.cruiseTime = shape.peakVelocity > 0 ? shape.cruiseDistance / shape.peakVelocity : 0;
+  return shape;
+}
+
+// Returns the target of a profile at a time in sec from its start.
+static ProfileSample sampleShape(const ProfileShape& shape, float t) {
+  float a = shape.acceleration;
+  float position;
+  float velocity;
+  if (t < shape.accelTime) {
+    velocity = shape.startVelocity + a * t;
+    position = (shape.startVelocity + velocity) * 0.5f * t;
+  } else if (t < shape.accelTime + shape.cruiseTime) {
+    velocity = shape.peakVelocity;
+    position = shape.accelDistance + shape.peakVelocity * (t - shape.accelTime);
+  } else if (t < shape.accelTime + shape.cruiseTime + shape.decelTime) {
+    float td = t - shape.accelTime - shape.cruiseTime;
+    velocity = shape.peakVelocity - a * td;
+    position = shape.accelDistance + shape.cruiseDistance + (shape.peakVelocity + velocity) * 0.5f * td;
+  } else {
+    velocity = shape.endVelocity;
+    position = shape.totalDistance;
+  }
+  ProfileSample sample;
+  sample.position = shape.direction * fminf(position, shape.totalDistance);
+  sample.velocity = shape.direction * velocity;
+  return sample;
+}
+
+bool sameProfile(const ProfileSpec& a, const ProfileSpec& b) {
+  return a.distance == b.distance && a.maxVelocity == b.maxVelocity && a.acceleration == b.acceleration
+      && a.startVelocity == b.startVelocity && a.endVelocity == b.endVelocity;
+}
+
+float profileDuration(const ProfileSpec& spec) {
+  ProfileShape shape = profileShape(spec);
+  return shape.accelTime + shape.cruiseTime + shape.decelTime;
+}
+
+ProfileSample profileAt(const ProfileSpec& spec, float time) {
+  return sampleShape(profileShape(spec), time);
+}
+
+int profileSampleCount(const ProfileSpec& spec) {
+  return (int)ceilf(profileDuration(spec) / PROFILE_DT) + 1;
+}
+
+int generateProfile(const ProfileSpec& spec, ProfileSample* samples, int maxSamples) {
+  ProfileShape shape = profileShape(spec);
+  float totalTime = shape.accelTime + shape.cruiseTime + shape.decelTime;
+  int sampleCount = (int)ceilf(totalTime / PROFILE_DT) + 1;
+  if (sampleCount > maxSamples) return 0;
+
+  for (int i = 0; i < sampleCount; i++) {
+    samples[i] = sampleShape(shape, fminf((i + 1) * PROFILE_DT, totalTime));
+  }
+  samples[sampleCount - 1].position = shape.direction * shape.totalDistance;
+  samples[sampleCount - 1].velocity = shape.direction * shape.endVelocity;
+  return sampleCount;
+}
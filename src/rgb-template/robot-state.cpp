@@ -0,0 +1,55 @@
+#include "vex.h"
+
+RobotState::RobotState(int driveMode, int autonSelection) :
+  publishedSnapshot(0),
+  snapshotSequence(0),
+  snapshotRetries(0),
+  drivetrainNeedsStopped(false),
+  joystickTouched(false),
+  desiredHeading(0),
+  driveMode(driveMode),
+  autonSelection(autonSelection),
+  autonTestStep(0),
+  macroRunning(false),
+  teamIsRed(true),
+  drivetrainOwner(OWNER_NONE)
+{
+  snapshot();
+}
+
+const RobotStateSnapshot& RobotState::snapshot() {
+  // Only the control loop publishes, so the buffer that is not published belongs to it.
+  int back = 1 - publishedSnapshot.load();
+  RobotStateSnapshot& state = snapshots[back];
+  state.drivetrainNeedsStopped = drivetrainNeedsStopped;
+  state.joystickTouched = joystickTouched;
+  state.desiredHeading = desiredHeading;
+  state.driveMode = driveMode;
+  state.autonSelection = autonSelection;
+  state.autonTestStep = autonTestStep;
+  state.macroRunning = macroRunning;
+  state.teamIsRed = teamIsRed;
+  state.drivetrainOwner = (driveOwner)drivetrainOwner.load();
+  publishedSnapshot = back;
+  snapshotSequence++;
+  return state;
+}
+
+RobotStateSnapshot RobotState::read() {
+  RobotStateSnapshot copy;
+  while (true) {
+    uint32_t sequence = snapshotSequence;
+    copy = snapshots[publishedSnapshot.load()];
+    // One publish in between writes the other buffer; two or more may have overwritten this one.
+    if (snapshotSequence - sequence < 2) return copy;
+    snapshotRetries++;
+  }
+}
+
+int RobotState::getSnapshotRetries() {
+  return snapshotRetries;
+}
+
+void RobotState::resetCounters() {
+  snapshotRetries = 0;
+}
@@ -0,0 +1,204 @@
+#include "vex.h"
+
+// "RGBD" in little-endian order.
+static const uint32_t MODEL_MAGIC = 0x44424752;
+// The file the model is saved in.
+static const char* const MODEL_FILE = "drive_model.bin";
+
+SystemId::SystemId() {
+  model = DriveModel();
+}
+
+void SystemId::addToFit(FeedforwardFit& fit, float voltage, float velocity, float acceleration) {
+  double x[3] = {velocity > 0 ? 1.0 : -1.0, velocity, acceleration};
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) fit.xx[i][j] += x[i] * x[j];
+    fit.xy[i] += x[i] * voltage;
+  }
+  fit.count++;
+}
+
+bool SystemId::solve(const FeedforwardFit& fit, float& kS, float& kV, float& kA) {
+  // Gaussian elimination with partial pivoting on the normal equations.
+  double a[3][4];
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) a[i][j] = fit.xx[i][j];
+    a[i][3] = fit.xy[i];
+  }
+  for (int col = 0; col < 3; col++) {
+    int pivot = col;
+    for (int row = col + 1; row < 3; row++) {
+      if (fabs(a[row][col]) > fabs(a[pivot][col])) pivot = row;
+    }
+    if (fabs(a[pivot][col]) < 1e-9) return false;
+    for (int j = 0; j < 4; j++) {
+      double swap = a[col][j];
+      a[col][j] = a[pivot][j];
+      a[pivot][j] = swap;
+    }
+    for (int row = 0; row < 3; row++) {
+      if (row == col) continue;
+      double factor = a[row][col] / a[col][col];
+      for (int j = col; j < 4; j++) a[row][j] -= factor * a[col][j];
+    }
+  }
+  kS = a[0][3] / a[0][0];
+  kV = a[1][3] / a[1][1];
+  kA = a[2][3] / a[2][2];
+  return true;
+}
+
+void SystemId::addSample(bool turning, const SystemIdSample& sample) {
+  history[historyCount % HISTORY] = sample;
+  historyCount++;
+  if (historyCount < HISTORY) return;
+
+  // The newest sample and the ones SPACING and 2 * SPACING samples before it. The velocity and acceleration
+  // are central differences around the middle one, which is where the voltage is taken.
+  const SystemIdSample& newest = history[(historyCount - 1) % HISTORY];
+  const SystemIdSample& middle = history[(historyCount - 1 - SPACING) % HISTORY];
+  const SystemIdSample& oldest = history[(historyCount - 1 - 2 * SPACING) % HISTORY];
+  float early = middle.time - oldest.time;
+  float late = newest.time - middle.time;
+  if (early <= 0 || late <= 0) return;
+  float span = early + late;
+
+  if (turning) {
+    float velocity = (newest.heading - oldest.heading) / span;
+    float acceleration = ((newest.heading - middle.heading) / late - (middle.heading - oldest.heading) / early) / (span * 0.5f);
+    // Stiction dominates below a few deg/sec, so those samples do not fit the model.
+    if (fabsf(velocity) < 5) return;
+    addToFit(turnFit, middle.voltage, velocity, acceleration);
+    // The wheels on either side move apart at the track width times the turn rate in rad/sec.
+    float wheelRate = ((newest.leftPosition - newest.rightPosition) - (oldest.leftPosition - oldest.rightPosition)) / span;
+    float gyroRate = velocity * (float)M_PI / 180.0f;
+    trackWheelRate += wheelRate * gyroRate;
+    trackGyroRate += gyroRate * gyroRate;
+  } else {
+    float newestPosition = (newest.leftPosition + newest.rightPosition) * 0.5f;
+    float middlePosition = (middle.leftPosition + middle.rightPosition) * 0.5f;
+    float oldestPosition = (oldest.leftPosition + oldest.rightPosition) * 0.5f;
+    float velocity = (newestPosition - oldestPosition) / span;
+    float acceleration = ((newestPosition - middlePosition) / late - (middlePosition - oldestPosition) / early) / (span * 0.5f);
+    if (fabsf(velocity) < 0.5f) return;
+    addToFit(driveFit, middle.voltage, velocity, acceleration);
+  }
+}
+
+void SystemId::runTest(bool turning, bool quasistatic, int direction) {
+  historyCount = 0;
+  float startTime = timer::system();
+  float startPosition = chassis.getDistanceTraveled();
+  float previousHeading = chassis.getHeading();
+  float heading = 0;
+  while (!robotState.drivetrainNeedsStopped) {
+    float time = (timer::system() - startTime) * 0.001f;
+    float voltage = direction * (quasistatic ? rampRate * time : stepVoltage);
+    if (fabsf(voltage) > 12 || time > 15) break;
+    chassis.driveWithVoltage(voltage, turning ? -voltage : voltage);
+    wait(5, msec);
+
+    SystemIdSample sample;
+    sample.time = (timer::system() - startTime) * 0.001f;
+    sample.voltage = voltage;
+    sample.leftPosition = chassis.getLeftPositionIn();
+    sample.rightPosition = chassis.getRightPositionIn();
+    float currentHeading = chassis.getHeading();
+    heading += wrap180(currentHeading - previousHeading);
+    previousHeading = currentHeading;
+    sample.heading = heading;
+    addSample(turning, sample);
+
+    if (turning ? fabsf(heading) > maxAngle : fabsf(chassis.getDistanceTraveled() - startPosition) > maxDistance) break;
+  }
+  // Coast to a stop before the next test.
+  chassis.driveWithVoltage(0, 0);
+  wait(1500, msec);
+}
+
+bool SystemId::run() {
+  driveFit = FeedforwardFit();
+  turnFit = FeedforwardFit();
+  trackWheelRate = 0;
+  trackGyroRate = 0;
+
+  // Each pair of tests drives out and back, so the robot ends about where it started.
+  printControllerScreen("sysid: straight", MESSAGE_NORMAL, 1000);
+  runTest(false, true, 1);
+  runTest(false, true, -1);
+  runTest(false, false, 1);
+  runTest(false, false, -1);
+  printControllerScreen("sysid: turning", MESSAGE_NORMAL, 1000);
+  runTest(true, true, 1);
+  runTest(true, true, -1);
+  runTest(true, false, 1);
+  runTest(true, false, -1);
+  if (robotState.drivetrainNeedsStopped) return false;
+
+  DriveModel fitted = DriveModel();
+  fitted.magic = MODEL_MAGIC;
+  if (!solve(driveFit, fitted.driveKs, fitted.driveKv, fitted.driveKa)
+      || !solve(turnFit, fitted.turnKs, fitted.turnKv, fitted.turnKa) || trackGyroRate <= 0) {
+    printControllerScreen("sysid: fit failed", MESSAGE_HIGH, 2000);
+    return false;
+  }
+  fitted.trackWidth = trackWheelRate / trackGyroRate;
+  fitted.driveSamples = driveFit.count;
+  fitted.turnSamples = turnFit.count;
+  fitted.checksum = checksum(fitted);
+  model = fitted;
+  modelValid = true;
+
+  save();
+  apply();
+  printModel();
+  return true;
+}
+
+uint32_t SystemId::checksum(const DriveModel& model) {
+  // FNV-1a over every field before the checksum.
+  const uint8_t* bytes = (const uint8_t*)&model;
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < sizeof(model) - sizeof(model.checksum); i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+bool SystemId::load() {
+  if (!Brain.SDcard.isInserted() || !Brain.SDcard.exists(MODEL_FILE)) return false;
+  DriveModel loaded;
+  int32_t size = Brain.SDcard.loadfile(MODEL_FILE, (uint8_t*)&loaded, sizeof(loaded));
+  if (size != sizeof(loaded) || loaded.magic != MODEL_MAGIC || loaded.checksum != checksum(loaded)) return false;
+  model = loaded;
+  modelValid = true;
+  return true;
+}
+
+bool SystemId::save() {
+  if (!modelValid || !Brain.SDcard.isInserted()) return false;
+  return Brain.SDcard.savefile(MODEL_FILE, (uint8_t*)&model, sizeof(model)) == sizeof(model);
+}
+
+void SystemId::apply() {
+  if (!modelValid) return;
+  chassis.setDriveFeedforward(model.driveKs, model.driveKv, model.driveKa);
+  chassis.setTurnFeedforward(model.turnKs, model.turnKv, model.turnKa);
+  chassis.setTrackWidth(model.trackWidth);
+}
+
+const DriveModel* SystemId::getModel() {
+  return modelValid ? &model : nullptr;
+}
+
+void SystemId::printModel() {
+  if (!modelValid) {
+    printControllerScreen("no drive model", MESSAGE_NORMAL, 1000);
+    return;
+  }
+  char msg[30];
+  sprintf(msg, "d %.2f %.3f %.3f", model.driveKs, model.driveKv, model.driveKa);
+  printControllerScreen(msg, MESSAGE_HIGH, 3000);
+  sprintf(msg, "t %.2f %.4f w%.1f", model.turnKs, model.turnKv, model.trackWidth);
+  printControllerScreen(msg, MESSAGE_HIGH, 3000);
+}
@@ -0,0 +1,152 @@
+#include "vex.h"
+
+// "RGBT" in little-endian order, plus the generator version. Change the version when the
+// profile generator changes, so profiles saved by an older version are rebuilt.
+static const uint32_t TRAJECTORY_MAGIC = 0x54424752 + 1;
+
+TrajectoryCache::TrajectoryCache() :
+  building(false)
+{
+  store.magic = TRAJECTORY_MAGIC;
+  store.contentHash = 0;
+  store.entryCount = 0;
+  store.sampleCount = 0;
+}
+
+void TrajectoryCache::precompute(const ProfileSpec* specs, int count) {
+  uint32_t contentHash = hashSpecs(specs, count);
+  cacheLock.lock();
+  // The same routine is selected again or run again, so its profiles are in memory or on their way.
+  bool current = building ? contentHash == pendingHash : contentHash == store.contentHash && store.entryCount > 0;
+  if (current) {
+    cacheLock.unlock();
+    return;
+  }
+  pendingSpecs = specs;
+  pendingCount = count;
+  pendingHash = contentHash;
+  building = true;
+  cacheLock.unlock();
+  thread buildThread = thread(buildTask, this);
+}
+
+int TrajectoryCache::buildTask(void* cache) {
+  static_cast<TrajectoryCache*>(cache)->build();
+  return 0;
+}
+
+uint32_t TrajectoryCache::hashSpecs(const ProfileSpec* specs, int count) {
+  // FNV-1a over the specs and the generator version.
+  uint32_t hash = 2166136261u ^ TRAJECTORY_MAGIC;
+  const uint8_t* bytes = (const uint8_t*)specs;
+  for (size_t i = 0; i < count * sizeof(ProfileSpec); i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+void TrajectoryCache::fileName(uint32_t contentHash, char* name, int size) {
+  snprintf(name, size, "traj_%08lx.bin", (unsigned long)contentHash);
+}
+
+void TrajectoryCache::build() {
+  uint64_t startTime = timer::systemHighResolution();
+  // Motion functions wait for the build rather than read a half-built store, and the build waits
+  // for the motions still following profiles from the store it replaces.
+  cacheLock.lock();
+  while (activeUsers > 0) {
+    cacheLock.unlock();
+    wait(5, msec);
+    cacheLock.lock();
+  }
+  uint32_t contentHash = pendingHash;
+
+  char name[20];
+  fileName(contentHash, name, sizeof(name));
+  int headerSize = sizeof(TrajectoryStore) - sizeof(store.samples);
+  loadedFromSD = false;
+  if (Brain.SDcard.isInserted() && Brain.SDcard.exists(name)) {
+    int32_t size = Brain.SDcard.loadfile(name, (uint8_t*)&store, sizeof(store));
+    loadedFromSD = size >= headerSize && store.magic == TRAJECTORY_MAGIC && store.contentHash == contentHash
+      && store.entryCount <= TrajectoryStore::MAX_ENTRIES && store.sampleCount <= TrajectoryStore::MAX_SAMPLES
+      && size == headerSize + store.sampleCount * (int)sizeof(ProfileSample);
+  }
+
+  if (!loadedFromSD) {
+    store.magic = TRAJECTORY_MAGIC;
+    store.entryCount = 0;
+    store.sampleCount = 0;
+    int sampleCount;
+    for (int i = 0; i < pendingCount; i++) append(pendingSpecs[i], sampleCount);
+    store.contentHash = contentHash;
+    if (Brain.SDcard.isInserted()) {
+      Brain.SDcard.savefile(name, (uint8_t*)&store, headerSize + store.sampleCount * sizeof(ProfileSample));
+    }
+  }
+  buildTime = timer::systemHighResolution() - startTime;
+  building = false;
+  cacheLock.unlock();
+}
+
+const ProfileSample* TrajectoryCache::append(const ProfileSpec& spec, int& sampleCount) {
+  if (store.entryCount >= TrajectoryStore::MAX_ENTRIES) return nullptr;
+  ProfileSample* samples = &store.samples[store.sampleCount];
+  sampleCount = generateProfile(spec, samples, TrajectoryStore::MAX_SAMPLES - store.sampleCount);
+  if (sampleCount == 0) return nullptr;
+  TrajectoryEntry& entry = store.entries[store.entryCount++];
+  entry.spec = spec;
+  entry.offset = store.sampleCount;
+  entry.sampleCount = sampleCount;
+  store.sampleCount += sampleCount;
+  return samples;
+}
+
+const ProfileSample* TrajectoryCache::get(const ProfileSpec& spec, int& sampleCount) {
+  cacheLock.lock();
+  for (int i = 0; i < store.entryCount; i++) {
+    if (sameProfile(store.entries[i].spec, spec)) {
+      hits++;
+      activeUsers++;
+      sampleCount = store.entries[i].sampleCount;
+      const ProfileSample* samples = &store.samples[store.entries[i].offset];
+      cacheLock.unlock();
+      return samples;
+    }
+  }
+  // Profiles built on demand are kept, so a repeated move is only built once.
+  misses++;
+  const ProfileSample* samples = append(spec, sampleCount);
+  if (samples != nullptr) activeUsers++;
+  cacheLock.unlock();
+  return samples;
+}
+
+void TrajectoryCache::release() {
+  cacheLock.lock();
+  if (activeUsers > 0) activeUsers--;
+  cacheLock.unlock();
+}
+
+bool TrajectoryCache::isReady() {
+  return !building;
+}
+
+int TrajectoryCache::getHits() {
+  return hits;
+}
+
+int TrajectoryCache::getMisses() {
+  return misses;
+}
+
+bool TrajectoryCache::wasLoadedFromSD() {
+  return loadedFromSD;
+}
+
+uint32_t TrajectoryCache::getBuildTime() {
+  return buildTime;
+}
+
+uint32_t TrajectoryCache::getContentHash() {
+  return store.contentHash;
+}
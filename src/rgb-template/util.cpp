@@ -1,57 +1,31 @@
 #include "vex.h"
 
 float normalize360(float angle) {
-  return fmod(angle + 360, 360);
+  return wrap360(angle);
 }
 
 float normalize180(float angle) {
-  return fmod(angle + 540, 360) - 180;
+  return wrap180(angle);
 }
 
 float threshold(float input, float min, float max){
-  if( input > max ){ return(max); }
-  if(input < min){ return(min); }
-  return(input);
+  return clampf(input, min, max);
 }
 
 float toVolt(float percent){
-  return(percent*12.0/100.0);
+  return percentToVolt(percent);
 }
 
 float deadband(float input, float width){
-  if (fabs(input)<width){
-    return(0);
-  }
-  return(input);
+  return deadbandf(input, width);
 }
 
-bool checkMotors(int motorCount, int temperatureLimit) {
-  int count = 0;
-  int t = 0;
-  for (int i = 0; i < 20; i++) {
-    motor m = motor(i);
-    if (m.installed()) {
-      count++;
-      t = m.temperature(celsius);
-      if (t > temperatureLimit) {
-        controller(primary).Screen.print("motor %d is %dC           ", i + 1, t);
-        controller(primary).rumble("---");
-        return false;
-      }
-    }
-  }
-  if (count < motorCount) {
-    controller(primary).Screen.print("%d motor is disconnected      ", motorCount - count);
-    controller(primary).rumble("---");
-    return false;
-  }
-  return true;
+void printControllerScreen(const char* message, messagePriority priority, uint32_t holdTime) {
+  controllerOutput.print(message, priority, holdTime);
 }
 
-void printControllerScreen(const char* message) {
-  char padded[25];
-  snprintf(padded, sizeof(padded), "%-24s", message);
-  controller(primary).Screen.print("%s", padded);
+void rumbleController(const char* pattern) {
+  controllerOutput.rumble(pattern);
 }
 
 
@@ -21,7 +21,12 @@ inertial inertial1 = inertial(PORT13);
 
 // 0: double arcade drive, 1: single aracde, 2: tank drive, 3: mecanum drive
 // -1: disable drive
-int DRIVE_MODE = 0;
+const int DRIVE_MODE = 0;
+
+// driver control loop period in msec
+const int DRIVER_LOOP_MS = 10;
+// set to true to measure the time from a stick change to its motor command and show the percentiles on the controller
+bool MEASURE_DRIVER_LATENCY = false;
 
 
 // ------------------------------------------------------------------------
@@ -31,14 +36,13 @@ motor rollerBottom = motor(PORT10, ratio6_1, false);
 motor rollerTop = motor(PORT19, ratio6_1, true);
 
 optical teamOptical = optical(PORT8);
-
-
-// total number of motors, including drivetrain
-const int NUMBER_OF_MOTORS = 8;
+optical sortOptical = optical(PORT9);
+distance frontDistance = distance(PORT7);
+// (optional) install a rotation sensor with a knob to select the auton by turning it
+rotation autonDial = rotation(PORT14);
 
 // (optional) intall an optical sensor right next to the license plate
-// teamIsRed variable will be automatically set to false if blue license plate is detected
-bool teamIsRed = true;
+// robotState.teamIsRed will be automatically set to false if blue license plate is detected
 
 
 // match load piston
@@ -59,28 +63,104 @@ bool toggleHorn(){
   return hornOn;
 }
 
+// the registry of the robot's motors. Commands are sent to the subsystem motors once per tick,
+// and every registered motor is checked for disconnects and overheating.
+// The rollers also run the color sort eject, so they are the eject motors.
+ActuatorRegistry actuators;
+int rollerBottomId = actuators.add("rollerBottom", rollerBottom, 12, brake);
+int rollerTopId = actuators.add("rollerTop", rollerTop, 12, brake);
+int leftMotor1Id = actuators.monitor("leftMotor1", leftMotor1);
+int leftMotor2Id = actuators.monitor("leftMotor2", leftMotor2);
+int leftMotor3Id = actuators.monitor("leftMotor3", leftMotor3);
+int rightMotor1Id = actuators.monitor("rightMotor1", rightMotor1);
+int rightMotor2Id = actuators.monitor("rightMotor2", rightMotor2);
+int rightMotor3Id = actuators.monitor("rightMotor3", rightMotor3);
+
+// the intake rollers. Tune jam detection with intakeRollers.setJamDetection() and setJamRecovery().
+Intake intakeRollers(actuators, rollerBottomId, rollerTopId);
+
 void intake() {
-  rollerBottom.spin(forward, 12, volt);
-  rollerTop.stop(coast);
+  intakeRollers.set(INTAKE_COLLECT);
 }
 
 void outTake() {
-  rollerBottom.spin(forward, -12, volt);
-  rollerTop.stop(coast);
+  intakeRollers.set(INTAKE_OUTTAKE);
 }
 
 void stopRollers() {
   // Stops the roller motors.
-  rollerBottom.stop(brake);
-  rollerTop.stop(brake);
+  intakeRollers.set(INTAKE_STOP);
 }
 
 
 void scoreLong() {
-  rollerBottom.spin(forward, 12, volt);
-  rollerTop.spin(forward, 12, volt);
+  intakeRollers.set(INTAKE_SCORE_LONG);
 }
 
+// Throws out an opponent game object while eject is true.
+void ejectRollers(bool eject) {
+  intakeRollers.setEjecting(eject);
+}
+
+float getFrontDistance() {
+  if (motionLog.isReplaying()) return motionLog.current().frontDistance;
+  if (!frontDistance.installed()) return 0;
+  float d = frontDistance.objectDistance(inches);
+  motionLog.noteFrontDistance(d);
+  return d;
+}
+
+// Macro step: drives until the front distance sensor reads the given distance in inches.
+bool macroDriveToWall(float targetDistance) {
+  float d = getFrontDistance();
+  // safety check to prevent driving when the distance reading is not valid.
+  if (d <= 0 || d > 48) return false;
+  return macroDriveDistance(d - targetDistance);
+}
+
+// Macro step: extends (1) or retracts (0) the match load piston.
+bool macroMatchLoad(float on) {
+  if (matchLoadOn != (on != 0)) toggleMatchLoad();
+  return true;
+}
+
+// Macro step: sets the intake state.
+bool macroIntake(float state) {
+  intakeRollers.set((intakeState)(int)state);
+  return true;
+}
+
+// Lines up with the match load station, cycles the match load piston while intaking,
+// then turns around to score. Touching a joystick cancels it at any point.
+MacroStep matchLoadMacro[] = {
+  {macroTurnToHeading, 180},
+  {macroDriveToWall, 14},
+  {macroIntake, INTAKE_COLLECT},
+  {macroMatchLoad, 1},
+  {macroWait, 600},
+  {macroMatchLoad, 0},
+  {macroWait, 300},
+  {macroMatchLoad, 1},
+  {macroWait, 600},
+  {macroMatchLoad, 0},
+  {macroIntake, INTAKE_STOP},
+  {macroDriveDistance, -6},
+  {macroTurnToHeading, 0},
+};
+
+// Stops the intake and retracts the match load piston when the match load macro is cancelled.
+void cancelMatchLoadMacro() {
+  intakeRollers.set(INTAKE_STOP);
+  if (matchLoadOn) toggleMatchLoad();
+}
+
+void startMatchLoadMacro() {
+  macroRunner.start(matchLoadMacro, sizeof(matchLoadMacro) / sizeof(matchLoadMacro[0]), cancelMatchLoadMacro);
+}
+
+// color sorting on the rollers. Tune the eject point with colorSort.setEjectTiming().
+ColorSort colorSort(sortOptical, rollerBottom, ejectRollers);
+
 
 
 // ------------------------------------------------------------------------
@@ -101,6 +181,37 @@ Drive chassis(
   0.75
 );
 
+// A global instance of the state shared between threads, starting in the configured drive mode
+// with no auton selected (-1 runs the quick test). Change -1 to set a default auton.
+RobotState robotState(DRIVE_MODE, -1);
+
+// A global instance of the arbiter that decides which source drives the chassis.
+ChassisArbiter chassisArbiter;
+
+// A global instance of the queue for controller screen messages and rumbles.
+ControllerOutput controllerOutput;
+
+// A global instance of the cache of precomputed motion profiles.
+TrajectoryCache trajectoryCache;
+
+// A global instance of the recorder that logs and replays the drivetrain's sensor readings and commands.
+MotionLog motionLog;
+
+// A global instance of the drivetrain characterization and its measured model.
+SystemId systemId;
+
+// A global instance of the macro runner for driver-control macros.
+MacroRunner macroRunner;
+
+// The turn gains scheduled by turn size, from the smallest turn to the largest.
+// Each row is: max turn size in deg, kp, ki, kd, starti, peak turn rate in deg/sec, angular acceleration in deg/sec^2.
+TurnGains turnSchedule[] = {
+  {10, 0.4, 0, 2, 0, 200, 2000},
+  {45, 0.3, 0, 2, 0, 400, 2000},
+  {90, 0.25, 0, 2.5, 0, 500, 2000},
+  {180, 0.22, 0, 3, 0, 550, 1800}
+};
+
 // Resets the chassis constants.
 void setChassisDefaults() {
   // Sets the heading of the chassis to the current heading of the inertial sensor.
@@ -112,6 +223,21 @@ void setChassisDefaults() {
   // Sets the turn PID constants for the chassis.
   // These constants are used to control the turning of the chassis.
   chassis.setTurnPID(10, 0.2, .015, 1.5, 7.5);
+  // Schedules the turn gains by turn size and follows a rotational profile on each turn.
+  // Remove this line to turn with the single set of PID constants above.
+  chassis.setTurnSchedule(turnSchedule, sizeof(turnSchedule) / sizeof(turnSchedule[0]));
+  // Sets the feedforward constants for following turn profiles.
+  // kV is 12 volts over the top turn rate, about 620 deg/sec; measure kS as the voltage where the robot starts to turn.
+  chassis.setTurnFeedforward(1.0, 0.0194, 0.0023);
+  // Sets the swing turn PID constants for the chassis.
+  // Only one side drives during a swing, so these are stiffer than the turn constants.
+  chassis.setSwingPID(10, 0.4, 0, 4, 0);
+  // Sets the distance between the centers of the left and right wheels in inches.
+  // Arcs use it to split the drive voltage between the sides; measure it on the robot.
+  chassis.setTrackWidth(12);
+  // Sets the feedforward constants for following drive profiles.
+  // kV is 12 volts over the free speed of the wheels, about 65 inch/sec for 600 rpm motors, 0.75 gear ratio and 2.75" wheels.
+  chassis.setDriveFeedforward(0, 0.185, 0);
   // Sets the heading PID constants for the chassis.
   // These constants are used to control the heading adjustment of the chassis.
   chassis.setHeadingPID(6, .4, 1);
@@ -121,62 +247,172 @@ void setChassisDefaults() {
   // Sets the exit conditions for the turn functions.
   // These conditions are used to determine when the turn function should exit.
   chassis.setTurnExitConditions(1.5, 200, 1500);
+  // Sets the exit conditions for swing turns and arcs.
+  chassis.setSwingExitConditions(1.5, 200, 1500);
+  chassis.setArcExitConditions(1, 200, 2500);
 
   // Sets the arcade drive constants for the chassis.
   // These constants are used to control the arcade drive of the chassis.
-  chassis.setArcadeConstants(0.5, 0.5, 0.85);
+  chassis.setArcadeConstants(2, 0.5, 0.85);
+  // Sets the active brake: volts per inch/sec of damping, the release speed in inch/sec that gets the
+  // full brake, and how long in msec the brake holds before the drivetrain coasts.
+  chassis.setActiveBrake(0.4, 30, 500);
 }
 
+// ------------------------------------------------------------------------
+//              Drive modes
+// ------------------------------------------------------------------------
+ArcadeMode doubleArcade(chassis, controller1.Axis2, controller1.Axis4);
+ArcadeMode singleArcade(chassis, controller1.Axis3, controller1.Axis4);
+TankMode tankDrive(chassis, controller1.Axis3, controller1.Axis2);
+MecanumMode mecanumDrive(chassis, controller1.Axis4, controller1.Axis3, controller1.Axis2, controller1.Axis1,
+                         leftMotor1, rightMotor1, leftMotor2, rightMotor2);
+
+// The acceleration limits and tip prevention of each drive mode: volts above the speed-holding voltage
+// when speeding up, volts below it when slowing down or reversing, the pitch/roll in degrees where tip
+// prevention starts, and volts per degree past it. The tall scoring mechanism wheelies on full-stick
+// reversals, so slowing down is limited harder than speeding up.
+DriveLimits arcadeLimits = {8, 6, 10, 0.5};
+DriveLimits mecanumLimits = {6, 5, 10, 0.5};
+
+// The drive modes in DRIVE_MODE order. Add new drive mode classes here.
+DriveModeEntry driveModeTable[] = {
+  driveModeEntry("Double Arcade", doubleArcade, arcadeLimits),
+  driveModeEntry("Single Arcade", singleArcade, arcadeLimits),
+  driveModeEntry("Tank Drive", tankDrive, arcadeLimits),
+  driveModeEntry("Mecanum Drive", mecanumDrive, mecanumLimits),
+};
+DriveModes driveModes(driveModeTable, sizeof(driveModeTable) / sizeof(driveModeTable[0]));
+
 void changeDriveMode(){
-  controller1.rumble("-");
-  DRIVE_MODE = (DRIVE_MODE +1)%3;
-    switch (DRIVE_MODE) {
-    case 0:
-      printControllerScreen("Double Arcade");
-      break;
-    case 1:
-      printControllerScreen("Single Arcade");
-      break;
-    case 2:
-      printControllerScreen("Tank Drive");
-      break;
-    case 3:
-      printControllerScreen("Mecanum Drive");
-      break;
-    }
+  rumbleController("-");
+  robotState.driveMode = driveModes.select(robotState.driveMode + 1);
+  printControllerScreen(driveModes.getName());
+}
+
+// Loop timing and stick-to-motor latency for the driver control loop. The latency is up to a loop
+// period plus the loop's work, so the bins are 250 usec wide.
+LoopTimer driverLoop(DRIVER_LOOP_MS);
+LatencyStats driverLatency(250);
+
+// Reports the stick-to-motor latency percentiles in msec on the controller screen.
+void printDriverLatency() {
+  char latencyMsg[30];
+  sprintf(latencyMsg, "lat %.2f/%.2f/%.2f", driverLatency.percentile(50) / 1000,
+    driverLatency.percentile(90) / 1000, driverLatency.percentile(99) / 1000);
+  printControllerScreen(latencyMsg, MESSAGE_LOW);
+}
+
+// ------------------------------------------------------------------------
+//              Brain screen dashboard
+// ------------------------------------------------------------------------
+void formatHeading(char* text, int size) {
+  snprintf(text, size, "heading %.1f", chassis.getHeading());
 }
 
+void formatDistance(char* text, int size) {
+  snprintf(text, size, "dist %.1f in", chassis.getDistanceTraveled());
+}
+
+void formatDriveTemperature(char* text, int size) {
+  motor* driveMotors[] = {&leftMotor1, &leftMotor2, &leftMotor3, &rightMotor1, &rightMotor2, &rightMotor3};
+  double hottest = 0;
+  for (int i = 0; i < 6; i++) hottest = fmax(hottest, driveMotors[i]->temperature(celsius));
+  snprintf(text, size, "drive %.0fC", hottest);
+}
+
+void formatRollerTemperature(char* text, int size) {
+  double hottest = 0;
+  for (int i = 0; i < actuators.getCount(); i++) hottest = fmax(hottest, actuators.getMotor(i).temperature(celsius));
+  snprintf(text, size, "rollers %.0fC", hottest);
+}
+
+void formatBattery(char* text, int size) {
+  snprintf(text, size, "battery %lu%% %.1fV", (unsigned long)Brain.Battery.capacity(), Brain.Battery.voltage(volt));
+}
+
+void formatLoopJitter(char* text, int size) {
+  snprintf(text, size, "jitter %.1f/%.1fms", driverLoop.getJitter() / 1000, driverLoop.getMaxJitter() / 1000);
+}
+
+// The names of the drivetrain sources, indexed by driveOwner.
+const char* driveOwnerNames[] = {"none", "driver", "macro", "auton", "safety"};
+
+// The dashboard runs on its own task, so it reads the state the driver loop last published instead
+// of the live values. The retries count how often a publish overwrote the state while it was read.
+void formatDriveOwner(char* text, int size) {
+  RobotStateSnapshot state = robotState.read();
+  snprintf(text, size, "%s retry %d", driveOwnerNames[state.drivetrainOwner], robotState.getSnapshotRetries());
+}
+
+void formatArbiterStats(char* text, int size) {
+  chassisArbiter.formatStats(text, size);
+}
+
+// The widgets on the brain screen, which is 480 x 240 pixels. Add new widgets here.
+// There is no pose widget: the drivetrain tracks no field position, only its heading and the distance
+// driven since it last stopped, so those two widgets are the pose it has.
+DashboardWidget dashboardWidgets[] = {
+  dashboardWidget(0, 0, 480, 40, mono30, formatAutonSelection),
+  dashboardWidget(0, 50, 240, 30, mono20, formatHeading),
+  dashboardWidget(240, 50, 240, 30, mono20, formatDistance),
+  dashboardWidget(0, 80, 240, 30, mono20, formatDriveTemperature),
+  dashboardWidget(240, 80, 240, 30, mono20, formatRollerTemperature),
+  dashboardWidget(0, 110, 240, 30, mono20, formatBattery),
+  dashboardWidget(240, 110, 240, 30, mono20, formatLoopJitter),
+  dashboardWidget(0, 140, 240, 30, mono20, formatDriveOwner),
+  dashboardWidget(240, 140, 240, 30, mono20, formatArbiterStats),
+};
+Dashboard dashboard(dashboardWidgets, sizeof(dashboardWidgets) / sizeof(dashboardWidgets[0]));
+
+// A global instance of the auton selector, reading the dial and keeping the selection on the SD card.
+AutonSelector autonSelector(autonDial);
+
 // This is the user control function.
 // It is called when the driver control period starts.
 void usercontrol(void) {
   // Exits the autonomous menu.
   exitAuton();
+  // Selects the drive mode once; the loop below only runs its control path.
+  driveModes.select(robotState.driveMode);
+  // The driver drives whenever no macro, autonomous or safety stop holds the drivetrain.
+  chassisArbiter.claim(OWNER_DRIVER);
+
+  int lastAxes[4] = {0, 0, 0, 0};
+  uint32_t lastReportTime = timer::system();
+  uint64_t lastSampleTime = timer::systemHighResolution();
 
   // This loop runs forever, controlling the robot during the driver control period.
+  driverLoop.start();
   while (1) {
-    if (!chassis.joystickTouched){
-      if(controller1.Axis1.position() != 0 || controller1.Axis2.position() != 0 
-        || controller1.Axis3.position() != 0 || controller1.Axis4.position() != 0) {
-        chassis.joystickTouched = true;
-      }
+    // Reads the shared state once, so every decision in this tick sees the same values.
+    const RobotStateSnapshot& state = robotState.snapshot();
+    uint64_t sampleTime = timer::systemHighResolution();
+    int axes[4] = {controller1.Axis1.position(), controller1.Axis2.position(),
+                   controller1.Axis3.position(), controller1.Axis4.position()};
+    bool sticksMoved = abs(axes[0]) > 5 || abs(axes[1]) > 5 || abs(axes[2]) > 5 || abs(axes[3]) > 5;
+    if (sticksMoved) {
+      robotState.joystickTouched = true;
+      // The driver takes over from a running macro within one loop.
+      if (state.macroRunning) macroRunner.cancel();
     }
-    switch (DRIVE_MODE) {
-    case 0: // double arcade
-      chassis.controlArcade(controller1.Axis2.position(), controller1.Axis4.position());
-      break;
-    case 1: // single arcade
-      chassis.controlArcade(controller1.Axis3.position(), controller1.Axis4.position());
-      break;
-    case 2: // tank drive
-      chassis.controlTank(controller1.Axis3.position(), controller1.Axis2.position());    
-      break;
-    case 3: // mecanum drive
-      chassis.controlMecanum(controller1.Axis4.position(), controller1.Axis3.position(), controller1.Axis2.position(), controller1.Axis1.position(), leftMotor1, leftMotor2, rightMotor1, rightMotor2);
-      break;
+    // The drive mode only runs while no higher source holds the drivetrain.
+    if (chassisArbiter.allowCommand(OWNER_DRIVER)) driveModes.control();
+
+    if (MEASURE_DRIVER_LATENCY) {
+      bool sticksChanged = axes[0] != lastAxes[0] || axes[1] != lastAxes[1]
+        || axes[2] != lastAxes[2] || axes[3] != lastAxes[3];
+      // A change seen in this read was made after the previous read, so it is timed from there until
+      // its motor command has been sent: the wait for this read plus the time the loop takes to act on it.
+      if (sticksChanged) driverLatency.record(timer::systemHighResolution() - lastSampleTime);
+      for (int i = 0; i < 4; i++) lastAxes[i] = axes[i];
+      if (timer::system() - lastReportTime > 5000) {
+        lastReportTime = timer::system();
+        printDriverLatency();
+      }
     }
-
-    // This wait prevents the loop from using too much CPU time.
-    wait(20, msec);
-   } 
+    lastSampleTime = sampleTime;
+    // Sleeps until the next tick so the loop runs at a fixed rate.
+    driverLoop.waitForNextTick();
+  }
 }
-
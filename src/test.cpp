@@ -5,8 +5,7 @@ void awp()
 {
   chassis.setHeading(0); 
   chassis.driveDistance(25);
-  rollerBottom.spin(forward, 6, volt);
-  rollerTop.spin(forward, -6, volt);
+  intakeRollers.setVoltage(6, -6);
   wait(100, msec);
   stopRollers();
   chassis.turnToHeading(90);
@@ -18,7 +17,7 @@ void awp()
   chassis.turnToHeading(180);
   chassis.driveDistance(24);
   chassis.turnToHeading(90);
-  float d = frontDistance.objectDistance(inches);
+  float d = getFrontDistance();
   chassis.driveDistance(d - 14);
   chassis.turnToHeading(180);
   wait(3, seconds);
@@ -0,0 +1,198 @@
+#include "vex.h"
+#include <chrono>
+
+// Runs the C++ template's Drive over a sensor trace and prints the motor commands of each tick, for
+// golden_trace.py to diff against the Python template's Drive. The robot code is built for the host, and
+// the trace is fed to the drive motors and the inertial sensor: one tick per wait() of the motion loops,
+// and one tick per call of the arcade control. Each run uses the template's own chassis defaults, so a
+// constant or a law that only one template has shows up as a divergence.
+
+// The drive motors of robot-config.cpp.
+extern motor leftMotor1, leftMotor2, leftMotor3, rightMotor1, rightMotor2, rightMotor3;
+
+// The settings of a trace, read from its "#" lines.
+struct TraceSettings
+{
+  // Target, max voltage, kp, ki, kd, starti, settle error, settle time, timeout.
+  float turn[9];
+  float drive[9];
+  // Max voltage, kp, kd.
+  float heading[3];
+};
+
+// A tick of a trace.
+struct TraceRow
+{
+  float heading;
+  float leftPosition;
+  float rightPosition;
+  float throttle;
+  float turn;
+};
+
+// The commands of a tick.
+struct TraceOutput
+{
+  float turnVoltage;
+  bool turnDone;
+  float leftVoltage;
+  float rightVoltage;
+  bool driveDone;
+  float arcadeLeft;
+  float arcadeRight;
+};
+
+// The motion whose commands the wait hook records.
+enum traceMotion { TRACE_TURN, TRACE_DRIVE };
+
+static const int MAX_ROWS = 4000;
+static TraceRow rows[MAX_ROWS];
+static TraceOutput outputs[MAX_ROWS];
+static int rowCount = 0;
+static int tick = 0;
+static traceMotion motion = TRACE_TURN;
+// The inches the wheels move per degree of motor rotation.
+static float inchesPerDegree = 1;
+
+static int readValues(const char* text, float* values, int count) {
+  int read = 0;
+  int used = 0;
+  while (read < count && sscanf(text, "%f%n", &values[read], &used) == 1) {
+    text += used;
+    read++;
+  }
+  return read;
+}
+
+static int readTrace(const char* fileName, TraceSettings& settings) {
+  FILE* file = fopen(fileName, "r");
+  if (file == nullptr) return -1;
+  char line[256];
+  int count = 0;
+  while (fgets(line, sizeof(line), file) && count < MAX_ROWS) {
+    if (strncmp(line, "# turn ", 7) == 0) readValues(line + 7, settings.turn, 9);
+    else if (strncmp(line, "# drive ", 8) == 0) readValues(line + 8, settings.drive, 9);
+    else if (strncmp(line, "# heading ", 10) == 0) readValues(line + 10, settings.heading, 3);
+    else {
+      TraceRow& row = rows[count];
+      if (sscanf(line, "%f,%f,%f,%f,%f", &row.heading, &row.leftPosition, &row.rightPosition, &row.throttle, &row.turn) == 5) count++;
+    }
+  }
+  fclose(file);
+  return count;
+}
+
+// Sets the readings of the drive motors and the inertial sensor to a tick of the trace. The wheel speed
+// is the change in position since the previous tick.
+static void feedRow(int i) {
+  const TraceRow& row = rows[i];
+  const TraceRow& previous = rows[i > 0 ? i - 1 : 0];
+  chassis.gyro.hostHeading = row.heading;
+  motor* leftMotors[] = {&leftMotor1, &leftMotor2, &leftMotor3};
+  motor* rightMotors[] = {&rightMotor1, &rightMotor2, &rightMotor3};
+  for (int m = 0; m < 3; m++) {
+    leftMotors[m]->hostPosition = row.leftPosition / inchesPerDegree;
+    leftMotors[m]->hostVelocity = (row.leftPosition - previous.leftPosition) / 0.01f / inchesPerDegree;
+    rightMotors[m]->hostPosition = row.rightPosition / inchesPerDegree;
+    rightMotors[m]->hostVelocity = (row.rightPosition - previous.rightPosition) / 0.01f / inchesPerDegree;
+  }
+}
+
+// Called at each wait() of a motion loop: records the command of the tick and feeds the next one. Once
+// the trace is used up, the motion is stopped.
+static void recordTick() {
+  TraceOutput& out = outputs[tick];
+  if (motion == TRACE_TURN) {
+    out.turnVoltage = leftMotor1.hostVoltage;
+    out.turnDone = false;
+  } else {
+    out.leftVoltage = leftMotor1.hostVoltage;
+    out.rightVoltage = rightMotor1.hostVoltage;
+    out.driveDone = false;
+  }
+  tick++;
+  if (tick < rowCount) feedRow(tick);
+  else robotState.drivetrainNeedsStopped = true;
+}
+
+// Runs the turn, the drive with heading correction and the arcade control over the trace once.
+static void run(const TraceSettings& settings) {
+  const float* t = settings.turn;
+  const float* d = settings.drive;
+  for (int i = 0; i < rowCount; i++) {
+    outputs[i].turnVoltage = 0;
+    outputs[i].turnDone = true;
+    outputs[i].leftVoltage = 0;
+    outputs[i].rightVoltage = 0;
+    outputs[i].driveDone = true;
+  }
+
+  // The ticks after a motion returns keep the done flag and no command.
+  host::onWait(recordTick);
+  motion = TRACE_TURN;
+  tick = 0;
+  feedRow(0);
+  chassis.setTurnPID(t[1], t[2], t[3], t[4], t[5]);
+  chassis.setTurnExitConditions(t[6], t[7], t[8]);
+  chassis.turnToHeading(t[0], t[1]);
+  robotState.drivetrainNeedsStopped = false;
+
+  // The drive holds the heading it started at.
+  motion = TRACE_DRIVE;
+  tick = 0;
+  feedRow(0);
+  chassis.setDrivePID(d[1], d[2], d[3], d[4], d[5]);
+  chassis.setDriveExitConditions(d[6], d[7], d[8]);
+  chassis.setHeadingPID(settings.heading[0], settings.heading[1], settings.heading[2]);
+  chassis.driveDistance(d[0], d[1], rows[0].heading, settings.heading[0]);
+  robotState.drivetrainNeedsStopped = false;
+  host::onWait(nullptr);
+
+  for (int i = 0; i < rowCount; i++) {
+    feedRow(i);
+    chassis.controlArcade(rows[i].throttle, rows[i].turn);
+    outputs[i].arcadeLeft = leftMotor1.hostVoltage;
+    outputs[i].arcadeRight = rightMotor1.hostVoltage;
+    host::advanceClock(10);
+  }
+  chassis.stop(coast);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s trace.csv [repeats]\n", argv[0]);
+    return 2;
+  }
+  TraceSettings settings = {};
+  rowCount = readTrace(argv[1], settings);
+  if (rowCount <= 0) {
+    fprintf(stderr, "%s: no samples\n", argv[1]);
+    return 2;
+  }
+  int repeats = argc > 2 ? atoi(argv[2]) : 50;
+
+  // The motions wait 10 msec per tick on the manual clock, so they run as fast as the host allows.
+  host::useManualClock();
+  setChassisDefaults();
+  driveModes.select(DRIVE_MODE);
+  leftMotor1.hostPosition = 1;
+  inchesPerDegree = chassis.getLeftPositionIn();
+
+  // The commands come from the first run. The later ones time the code, many times over so the cost per
+  // tick is not lost in the clock resolution.
+  run(settings);
+  static TraceOutput first[MAX_ROWS];
+  memcpy(first, outputs, sizeof(TraceOutput) * rowCount);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeats; i++) run(settings);
+  double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  printf("tick,turnVoltage,turnDone,leftVoltage,rightVoltage,driveDone,arcadeLeft,arcadeRight\n");
+  for (int i = 0; i < rowCount; i++) {
+    const TraceOutput& out = first[i];
+    printf("%d,%.6f,%d,%.6f,%.6f,%d,%.6f,%.6f\n", i, out.turnVoltage, out.turnDone ? 1 : 0,
+           out.leftVoltage, out.rightVoltage, out.driveDone ? 1 : 0, out.arcadeLeft, out.arcadeRight);
+  }
+  printf("# cost_ns %.1f\n", elapsed / repeats / rowCount);
+  return 0;
+}
@@ -0,0 +1,181 @@
+"""Feeds recorded sensor traces through the C++ and Python templates' Drive and diffs their commands tick by tick.
+
+Usage: python3 golden_trace.py --cpp build/golden-trace traces/*.csv
+
+The C++ side is golden-trace.cpp, built with the robot code for the host. The Python side is the Drive
+class of RGB-Template-Python/src/main.py on the stub devices of vex.py. Each side sets its own chassis
+defaults, then runs turn_to_heading, drive_distance holding the starting heading, and control_arcade on
+the trace's joystick values, with the trace fed to the drive motors and the inertial sensor one tick per
+wait. So the turn schedule and profile, the heading correction, the joystick curve, the acceleration
+limits and the active brake are all compared, and a constant or a law that only one template has shows
+up as a divergence. The report shows the first tick where the commands differ, the largest difference
+and the compute cost per tick of each. The exit code is 1 if any trace diverges.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, HERE)
+sys.path.insert(1, os.path.join(HERE, "..", "..", "RGB-Template-Python", "src"))
+import main as template  # noqa: E402
+import vex  # noqa: E402
+
+# Commands closer than this are the same, in volts. The C++ side runs in single precision and the
+# Python side in double.
+TOLERANCE = 1e-3
+FIELDS = ["turnVoltage", "turnDone", "leftVoltage", "rightVoltage", "driveDone", "arcadeLeft", "arcadeRight"]
+LEFT_MOTORS = [template.left_motor1, template.left_motor2, template.left_motor3]
+RIGHT_MOTORS = [template.right_motor1, template.right_motor2, template.right_motor3]
+
+
+def read_trace(file_name):
+    settings = {}
+    rows = []
+    with open(file_name) as trace:
+        for line in trace:
+            if line.startswith("#"):
+                parts = line[1:].split()
+                settings[parts[0]] = [float(value) for value in parts[1:]]
+            elif line[0].isdigit() or line[0] == "-":
+                rows.append([float(value) for value in line.split(",")])
+    return settings, rows
+
+
+def feed_row(chassis, rows, i):
+    """Set the drive motors and the inertial sensor to a tick of the trace. The wheel speed is the change
+    in position since the previous tick."""
+    heading, left, right = rows[i][:3]
+    previous = rows[i - 1] if i > 0 else rows[0]
+    chassis.gyro.host_heading = heading
+    for motor in LEFT_MOTORS:
+        motor.host_position = left / chassis.drive_in_to_deg_ratio
+        motor.host_velocity = (left - previous[1]) / 0.01 / chassis.drive_in_to_deg_ratio
+    for motor in RIGHT_MOTORS:
+        motor.host_position = right / chassis.drive_in_to_deg_ratio
+        motor.host_velocity = (right - previous[2]) / 0.01 / chassis.drive_in_to_deg_ratio
+
+
+def run_motion(chassis, rows, outputs, record, motion):
+    """Run a motion with one trace tick per wait, recording each tick's command. Once the trace is used up,
+    the motion is stopped. The ticks after a motion returns keep the done flag and no command."""
+    tick = [0]
+
+    def record_tick():
+        record(outputs[tick[0]])
+        tick[0] += 1
+        if tick[0] < len(rows):
+            feed_row(chassis, rows, tick[0])
+        else:
+            chassis.drivetrain_needs_stopped = True
+
+    vex.on_wait(record_tick)
+    feed_row(chassis, rows, 0)
+    motion()
+    vex.on_wait(None)
+    chassis.drivetrain_needs_stopped = False
+
+
+def record_turn(out):
+    out[0] = template.left_motor1.host_voltage
+    out[1] = 0
+
+
+def record_drive(out):
+    out[2] = template.left_motor1.host_voltage
+    out[3] = template.right_motor1.host_voltage
+    out[4] = 0
+
+
+def run_python(settings, rows):
+    t = settings["turn"]
+    d = settings["drive"]
+    h = settings["heading"]
+    # A fresh chassis on the template's own defaults, as the C++ side uses
+    chassis = template.chassis = template.Drive(template.left_drive, template.right_drive, template.inertial_1,
+                                                template.WHEEL_DIAMETER, template.GEAR_RATIO)
+    template.set_chassis_defaults()
+    chassis.set_drive_limits(template.drive_mode_limits[template.DRIVE_MODE])
+    outputs = [[0.0, 1, 0.0, 0.0, 1, 0.0, 0.0] for _ in rows]
+
+    chassis.set_turn_pid(t[1], t[2], t[3], t[4], t[5])
+    chassis.set_turn_exit_conditions(t[6], t[7], t[8])
+    run_motion(chassis, rows, outputs, record_turn, lambda: chassis.turn_to_heading(t[0], t[1]))
+
+    # The drive holds the heading it started at.
+    chassis.set_drive_pid(d[1], d[2], d[3], d[4], d[5])
+    chassis.set_drive_exit_conditions(d[6], d[7], d[8])
+    chassis.set_heading_pid(h[0], h[1], h[2])
+    run_motion(chassis, rows, outputs, record_drive, lambda: chassis.drive_distance(d[0], d[1], rows[0][0], h[0]))
+
+    for i, row in enumerate(rows):
+        feed_row(chassis, rows, i)
+        chassis.control_arcade(int(row[3]), int(row[4]))
+        outputs[i][5] = template.left_motor1.host_voltage
+        outputs[i][6] = template.right_motor1.host_voltage
+        vex.host_time += 10
+    chassis.stop(template.BrakeType.COAST)
+    return outputs
+
+
+def time_python(settings, rows, repeats):
+    start = time.perf_counter_ns()
+    for _ in range(repeats):
+        run_python(settings, rows)
+    return (time.perf_counter_ns() - start) / repeats / len(rows)
+
+
+def run_cpp(binary, file_name):
+    result = subprocess.run([binary, file_name], check=True, capture_output=True, text=True)
+    outputs = []
+    cost = 0.0
+    for line in result.stdout.splitlines():
+        if line.startswith("# cost_ns"):
+            cost = float(line.split()[2])
+        elif line[0].isdigit():
+            outputs.append([float(value) for value in line.split(",")[1:]])
+    return outputs, cost
+
+
+def compare(file_name, binary, repeats):
+    settings, rows = read_trace(file_name)
+    cpp_outputs, cpp_cost = run_cpp(binary, file_name)
+    py_outputs = run_python(settings, rows)
+    py_cost = time_python(settings, rows, repeats)
+
+    first_divergence = None
+    largest = [0.0] * len(FIELDS)
+    for tick, (cpp, py) in enumerate(zip(cpp_outputs, py_outputs)):
+        for i, (a, b) in enumerate(zip(cpp, py)):
+            difference = abs(a - b)
+            largest[i] = max(largest[i], difference)
+            if difference > TOLERANCE and first_divergence is None:
+                first_divergence = (tick, FIELDS[i], a, b)
+    if len(cpp_outputs) != len(py_outputs):
+        first_divergence = first_divergence or (min(len(cpp_outputs), len(py_outputs)), "ticks", len(cpp_outputs), len(py_outputs))
+
+    name = os.path.basename(file_name)
+    print("%s: %d ticks, C++ %.0f ns/tick, Python %.0f ns/tick" % (name, len(rows), cpp_cost, py_cost))
+    print("  largest difference: " + ", ".join("%s %.2g" % (field, value) for field, value in zip(FIELDS, largest)))
+    if first_divergence:
+        print("  DIVERGES at tick %d: %s C++ %.6f Python %.6f" % first_divergence)
+        return False
+    print("  matches")
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--cpp", required=True, help="the golden-trace binary built from golden-trace.cpp")
+    parser.add_argument("--repeats", type=int, default=20, help="runs of each trace for the Python cost")
+    parser.add_argument("traces", nargs="+")
+    args = parser.parse_args()
+    results = [compare(trace, args.cpp, args.repeats) for trace in args.traces]
+    return 0 if all(results) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
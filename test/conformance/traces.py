@@ -0,0 +1,143 @@
+"""Writes the sensor traces the conformance check runs on.
+
+python3 traces.py                  rewrites the sample traces in traces/
+python3 traces.py motion.bin out.csvconverts a motion log from the robot's SD card to a trace
+
+The sample traces come from a plant with the drivetrain's estimated feedforward constants, driven by a
+plain PD loop, with seeded noise on the sensors. They only need to look like a robot: both templates are
+fed the same readings open loop, so the plant does not have to match either of them.
+"""
+
+import math
+import os
+import random
+import struct
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# The gains of setChassisDefaults() in robot-config.cpp and set_chassis_defaults() in main.py.
+# turn and drive: target, max voltage, kp, ki, kd, starti, settle error, settle time, timeout.
+TURN = [10, 0.2, 0.015, 1.5, 7.5, 1.5, 200, 1500]
+DRIVE = [10, 1.5, 0, 10, 0, 1, 200, 2000]
+HEADING = [6, 0.4, 1]
+
+# The plant: volts to overcome static friction, volts per unit/sec and volts per unit/sec^2,
+# for driving in inches and turning in degrees.
+DRIVE_PLANT = (0.6, 0.185, 0.03)
+TURN_PLANT = (1.0, 0.0194, 0.0023)
+TRACK_WIDTH = 12
+
+# The layout of a MotionLogStore in motion-log.h: magic, auton, sample count, then six floats a sample.
+MOTION_LOG_HEADER = struct.Struct("<Iii")
+MOTION_LOG_SAMPLE = struct.Struct("<6f")
+
+
+def accelerate(speed, voltage, plant, dt):
+    k_s, k_v, k_a = plant
+    if speed == 0 and abs(voltage) <= k_s:
+        return 0.0
+    direction = math.copysign(1, speed if speed != 0 else voltage)
+    return speed + (voltage - k_s * direction - k_v * speed) / k_a * dt
+
+
+def write_trace(path, turn_target, drive_target, rows):
+    with open(path, "w") as trace:
+        trace.write("# turn %g %s\n" % (turn_target, " ".join("%g" % value for value in TURN)))
+        trace.write("# drive %g %s\n" % (drive_target, " ".join("%g" % value for value in DRIVE)))
+        trace.write("# heading %s\n" % " ".join("%g" % value for value in HEADING))
+        trace.write("heading,left,right,throttle,turn\n")
+        for row in rows:
+            trace.write("%.4f,%.4f,%.4f,%.0f,%.0f\n" % row)
+
+
+def simulate(start_heading, turn_angle, distance, ticks, seed):
+    """Turns by turn_angle, or drives distance if turn_angle is 0, with a PD loop on the plant."""
+    noise = random.Random(seed)
+    heading = start_heading
+    velocity = turn_rate = left = right = 0.0
+    previous_error = None
+    rows = []
+    for _ in range(ticks):
+        # The inertial sensor reads to about 0.01 deg and the encoders to about 0.01 inch.
+        rows.append(((heading + noise.gauss(0, 0.02)) % 360, left + noise.gauss(0, 0.005),
+                     right + noise.gauss(0, 0.005), 0, 0))
+        error = (start_heading + turn_angle - heading) if turn_angle else (distance - (left + right) / 2)
+        output = 0.3 * error + (2.0 * (error - previous_error) if previous_error is not None else 0)
+        previous_error = error
+        output = max(-10.0, min(10.0, output))
+        drive_voltage, turn_voltage = (0.0, output) if turn_angle else (output, 0.0)
+        for _ in range(5):
+            velocity = accelerate(velocity, drive_voltage, DRIVE_PLANT, 0.002)
+            turn_rate = accelerate(turn_rate, turn_voltage, TURN_PLANT, 0.002)
+            turn_speed = math.radians(turn_rate) * TRACK_WIDTH / 2
+            left += (velocity + turn_speed) * 0.002
+            right += (velocity - turn_speed) * 0.002
+            heading += turn_rate * 0.002
+    return rows
+
+
+def sweep_sticks(ticks):
+    """Sweeps both sticks through their full range, holding the robot still."""
+    rows = []
+    for tick in range(ticks):
+        throttle = round(100 * math.sin(tick * 0.02))
+        turn = round(100 * math.sin(tick * 0.031 + 1))
+        rows.append((0.0, 0.0, 0.0, throttle, turn))
+    return rows
+
+
+def drive_sticks(ticks, seed):
+    """Pushes the sticks and releases them in turn, with the plant driven open loop at the stick voltage,
+    so the acceleration limits see the wheels moving and the active brake runs after each release."""
+    noise = random.Random(seed)
+    # Throttle, turn and the number of ticks each is held.
+    phases = [(80, 0, 60), (0, 0, 70), (60, 70, 60), (0, 0, 70), (-100, 0, 50), (0, 0, 40), (30, -40, 30), (0, 0, 20)]
+    heading = left = right = 0.0
+    left_speed = right_speed = 0.0
+    rows = []
+    for throttle, turn, length in phases:
+        for _ in range(length):
+            if len(rows) == ticks:
+                return rows
+            rows.append(((heading + noise.gauss(0, 0.02)) % 360, left + noise.gauss(0, 0.005),
+                         right + noise.gauss(0, 0.005), throttle, turn))
+            left_voltage = max(-12.0, min(12.0, (throttle + turn) * 0.12))
+            right_voltage = max(-12.0, min(12.0, (throttle - turn) * 0.12))
+            for _ in range(5):
+                left_speed = accelerate(left_speed, left_voltage, DRIVE_PLANT, 0.002)
+                right_speed = accelerate(right_speed, right_voltage, DRIVE_PLANT, 0.002)
+                left += left_speed * 0.002
+                right += right_speed * 0.002
+                heading += math.degrees((left_speed - right_speed) / TRACK_WIDTH) * 0.002
+    return rows
+
+
+def write_samples():
+    folder = os.path.join(HERE, "traces")
+    write_trace(os.path.join(folder, "turn_90.csv"), 90, 0, simulate(0, 90, 0, 200, 1))
+    write_trace(os.path.join(folder, "turn_wrap.csv"), 20, 0, simulate(350, 30, 0, 200, 2))
+    write_trace(os.path.join(folder, "turn_180.csv"), 180, 0, simulate(0, 180, 0, 250, 3))
+    write_trace(os.path.join(folder, "drive_24.csv"), 0, 24, simulate(0, 0, 24, 250, 4))
+    write_trace(os.path.join(folder, "sticks.csv"), 0, 0, sweep_sticks(400))
+    write_trace(os.path.join(folder, "sticks_driven.csv"), 0, 0, drive_sticks(400, 5))
+
+
+def convert_log(log_name, out_name):
+    with open(log_name, "rb") as log:
+        data = log.read()
+    _, auton, count = MOTION_LOG_HEADER.unpack_from(data)
+    samples = [MOTION_LOG_SAMPLE.unpack_from(data, MOTION_LOG_HEADER.size + i * MOTION_LOG_SAMPLE.size)
+               for i in range(count)]
+    rows = [(heading, left, right, 0, 0) for heading, left, right, _, _, _ in samples]
+    # A log holds a whole auton, so the loops target where the robot ended up.
+    final = samples[-1]
+    write_trace(out_name, final[0], (final[1] + final[2]) / 2, rows)
+    print("auton %d: %d samples" % (auton, count))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) == 3:
+        convert_log(sys.argv[1], sys.argv[2])
+    else:
+        write_samples()
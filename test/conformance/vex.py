@@ -0,0 +1,135 @@
+"""A host stand-in for the VEX Python module, so the template's main.py can be imported on Linux or macOS.
+
+The drive motors, motor groups, the inertial sensor and the brain's timer keep their readings in public
+host_* fields, which golden_trace.py sets from a sensor trace, and the motors record the last voltage
+they were given. wait() advances a manual clock and calls the hook set with on_wait() first, so a motion
+loop runs one trace tick per wait. Every other device, enum and function is a stub that accepts any
+arguments and does nothing.
+"""
+
+
+class _Stub:
+    def __init__(self, *args, **kwargs):
+        pass
+
+    def __call__(self, *args, **kwargs):
+        return _Stub()
+
+    def __getattr__(self, name):
+        return _Stub()
+
+    def __float__(self):
+        return 0.0
+
+    def __int__(self):
+        return 0
+
+
+class _Units:
+    """An enum whose members are their own names, so units can be told apart."""
+
+    def __getattr__(self, name):
+        return name
+
+
+Competition = Controller = _Stub
+ControllerType = FontType = GearSetting = Ports = _Stub()
+BrakeType = RotationUnits = TemperatureUnits = TimeUnits = VelocityUnits = VoltageUnits = _Units()
+FORWARD = "FORWARD"
+
+# The manual clock in msec, and the function wait() calls before it moves the clock on.
+host_time = 0.0
+_wait_hook = None
+
+
+def on_wait(hook):
+    global _wait_hook
+    _wait_hook = hook
+
+
+def wait(time, units=None):
+    global host_time
+    if _wait_hook is not None:
+        _wait_hook()
+    host_time += time * 1000 if units == TimeUnits.SEC else time
+
+
+class Motor(_Stub):
+    def __init__(self, *args, **kwargs):
+        self.host_voltage = 0.0
+        self.host_position = 0.0  # deg
+        self.host_velocity = 0.0  # deg/sec
+
+    def spin(self, direction, value=0.0, units=None):
+        self.host_voltage = value
+
+    def stop(self, mode=None):
+        self.host_voltage = 0.0
+
+    def position(self, units=None):
+        return self.host_position / 360.0 if units == RotationUnits.REV else self.host_position
+
+    def velocity(self, units=None):
+        if units == VelocityUnits.RPM:
+            return self.host_velocity / 6.0
+        return self.host_velocity
+
+    def reset_position(self):
+        self.host_position = 0.0
+
+    def set_position(self, value, units=None):
+        self.host_position = value
+
+
+class MotorGroup(_Stub):
+    """Commands go to every motor; readings come from the first, as on the brain."""
+
+    def __init__(self, *motors):
+        self.motors = motors
+
+    def spin(self, direction, value=0.0, units=None):
+        for motor in self.motors:
+            motor.spin(direction, value, units)
+
+    def stop(self, mode=None):
+        for motor in self.motors:
+            motor.stop(mode)
+
+    def position(self, units=None):
+        return self.motors[0].position(units)
+
+    def velocity(self, units=None):
+        return self.motors[0].velocity(units)
+
+    def reset_position(self):
+        for motor in self.motors:
+            motor.reset_position()
+
+
+class Inertial(_Stub):
+    def __init__(self, *args, **kwargs):
+        self.host_heading = 0.0
+        self.host_pitch = 0.0
+        self.host_roll = 0.0
+
+    def heading(self, units=None):
+        return self.host_heading % 360.0
+
+    def set_heading(self, value, units=None):
+        self.host_heading = value
+
+    def pitch(self, units=None):
+        return self.host_pitch
+
+    def roll(self, units=None):
+        return self.host_roll
+
+
+class _Timer(_Stub):
+    def system(self):
+        return int(host_time)
+
+
+class Brain(_Stub):
+    def __init__(self, *args, **kwargs):
+        self.timer = _Timer()
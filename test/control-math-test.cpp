@@ -0,0 +1,135 @@
+#include "vex.h"
+#include <chrono>
+
+// Checks the float-only control math against the functions it replaced in util.cpp and drive.cpp,
+// and times both. Exits with 1 if a result is out of range or further from the old one than its tolerance.
+
+// The old util.cpp and drive.cpp versions, as they were before control-math.h.
+static float oldNormalize360(float angle) {
+  return fmod(angle + 360, 360);
+}
+
+static float oldNormalize180(float angle) {
+  return fmod(angle + 540, 360) - 180;
+}
+
+static float oldThreshold(float input, float min, float max) {
+  if (input > max) return max;
+  if (input < min) return min;
+  return input;
+}
+
+static double oldCurveFunction(double x, double curveScale) {
+  return (powf(2.718, -(curveScale / 10)) + powf(2.718, (fabs(x) - 100) / 10) * (1 - powf(2.718, -(curveScale / 10)))) * x;
+}
+
+static int failures = 0;
+
+// Compares new and old results over inputs. Reports the largest difference and how many were bit-identical.
+static void report(const char* name, float largest, int identical, int count, float tolerance) {
+  bool passed = largest <= tolerance;
+  if (!passed) failures++;
+  printf("%-10s max diff %.3g (tolerance %.3g), %d of %d bit-identical  %s\n", name, largest, tolerance,
+         identical, count, passed ? "ok" : "FAIL");
+}
+
+static void checkRange(const char* name, float value, float min, float max, float input) {
+  if (value >= min && value < max) return;
+  if (failures < 20) printf("%s(%.9g) = %.9g is outside [%g, %g)\n", name, input, value, min, max);
+  failures++;
+}
+
+static void testWrap() {
+  float largest360 = 0, largest180 = 0;
+  int identical360 = 0, identical180 = 0, count = 0;
+  // Every heading error the loops see is the difference of two headings in [0, 360), plus the edges.
+  for (int i = -72000; i <= 144000; i++) {
+    float angle = i * 0.005f;
+    float new360 = wrap360(angle);
+    float new180 = wrap180(angle);
+    checkRange("wrap360", new360, 0, 360, angle);
+    checkRange("wrap180", new180, -180, 180, angle);
+    // The old functions return negative angles below -360 and -540, so they are only compared above that.
+    if (angle < -360) continue;
+    count++;
+    float old360 = oldNormalize360(angle);
+    float old180 = oldNormalize180(angle);
+    // Both ends of the range are the same angle.
+    float diff360 = fabsf(wrap180(new360 - old360));
+    float diff180 = fabsf(wrap180(new180 - old180));
+    if (diff360 > largest360) largest360 = diff360;
+    if (diff180 > largest180) largest180 = diff180;
+    if (new360 == old360) identical360++;
+    if (new180 == old180) identical180++;
+  }
+  report("wrap360", largest360, identical360, count, 1e-4f);
+  report("wrap180", largest180, identical180, count, 1e-4f);
+
+  const float edges[] = {0, 360, -360, 180, -180, 359.99998f, -0.00001f, 720, -720, 1e6f, -1e6f};
+  for (float edge : edges) {
+    checkRange("wrap360", wrap360(edge), 0, 360, edge);
+    checkRange("wrap180", wrap180(edge), -180, 180, edge);
+  }
+}
+
+static void testClamp() {
+  float largest = 0;
+  int identical = 0, count = 0;
+  for (int i = -3000; i <= 3000; i++) {
+    float input = i * 0.01f;
+    float newValue = clampf(input, -12, 12);
+    float oldValue = oldThreshold(input, -12, 12);
+    largest = fmaxf(largest, fabsf(newValue - oldValue));
+    if (newValue == oldValue) identical++;
+    count++;
+  }
+  report("clampf", largest, identical, count, 0);
+}
+
+static void testCurve() {
+  const float scales[] = {0, 5, 10, 20};
+  float largest = 0;
+  int identical = 0, count = 0;
+  for (float scale : scales) {
+    float curveMin = curveMinimum(scale);
+    for (int i = -1000; i <= 1000; i++) {
+      float x = i * 0.1f;
+      float newValue = curve(x, curveMin);
+      float oldValue = oldCurveFunction(x, scale);
+      largest = fmaxf(largest, fabsf(newValue - oldValue));
+      if (newValue == oldValue) identical++;
+      count++;
+    }
+  }
+  report("curve", largest, identical, count, 1e-4f);
+}
+
+// Times a function over a sweep of inputs in nsec per call.
+template <typename Function>
+static double timeCalls(Function function) {
+  const int calls = 2000000;
+  volatile float sink = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < calls; i++) sink = sink + function((i % 14400) * 0.05f - 360);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+}
+
+static void benchmark() {
+  float curveMin = curveMinimum(5);
+  printf("\nnsec per call on this host, new / old:\n");
+  printf("wrap360    %.2f / %.2f\n", timeCalls([](float x) { return wrap360(x); }), timeCalls([](float x) { return oldNormalize360(x); }));
+  printf("wrap180    %.2f / %.2f\n", timeCalls([](float x) { return wrap180(x); }), timeCalls([](float x) { return oldNormalize180(x); }));
+  printf("clampf     %.2f / %.2f\n", timeCalls([](float x) { return clampf(x, -12, 12); }),
+         timeCalls([](float x) { return oldThreshold(x, -12, 12); }));
+  printf("curve      %.2f / %.2f\n", timeCalls([curveMin](float x) { return curve(x * 0.25f, curveMin); }),
+         timeCalls([](float x) { return (float)oldCurveFunction(x * 0.25f, 5); }));
+}
+
+int main() {
+  testWrap();
+  testClamp();
+  testCurve();
+  benchmark();
+  if (failures > 0) printf("\n%d failures\n", failures);
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+// A host stand-in for the VEX SDK, so the robot code builds and runs on Linux or macOS for the
+// simulation tools under test/. The devices are in v5_vcs.h.
+#include <stdint.h>
+#include <stdarg.h>
@@ -0,0 +1,423 @@
+#pragma once
+// A host stand-in for the VEX SDK devices, so the robot code builds and runs on Linux or macOS.
+// Every device keeps what was last written to it and reads back the host* fields, which a tool sets
+// to feed it sensor values. Nothing moves by itself: the drivetrain moves when a DriveSimulation is
+// attached to the chassis. Threads are host threads, and the clock is the host's steady clock unless
+// a tool switches to the manual clock, which only moves when the tool advances it or a thread waits.
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <math.h>
+#include <mutex>
+
+// The host controls that have no counterpart on the brain.
+namespace host {
+  // Makes the clock stand still until advanceClock() or wait() moves it, so a tool runs in simulated time.
+  void useManualClock();
+  // Moves the manual clock on by a time in msec.
+  void advanceClock(double time);
+  // Calls a function each time the thread that owns the manual clock waits, before the clock moves on.
+  // A tool uses it to feed sensor readings tick by tick to code that waits between ticks. nullptr removes it.
+  void onWait(void (*hook)());
+  // Sets the directory the SD card files are read from and written to. The default is the working directory.
+  void setSdRoot(const char* path);
+  // Returns the time in usec of the host clock, real or manual.
+  uint64_t clockMicros();
+  // Sleeps for a time in msec, or moves the manual clock on by it.
+  void sleepMillis(double time);
+}
+
+namespace vex {
+enum timeUnits { msec, sec, seconds };
+enum voltageUnits { volt, voltageUnits_mV };
+enum rotationUnits { deg, rev, raw };
+enum velocityUnits { pct, rpm, dps };
+enum percentUnits { percent };
+enum currentUnits { amp };
+enum torqueUnits { Nm, InLb };
+enum powerUnits { watt };
+enum temperatureUnits { celsius, fahrenheit };
+enum distanceUnits { mm, inches, cm };
+enum directionType { fwd, forward = fwd, reverse };
+enum brakeType { coast, brake, hold };
+enum gearSetting { ratio36_1, ratio18_1, ratio6_1 };
+enum controllerType { primary, partner };
+enum fontType { mono20, mono30, mono40, mono12, mono15, prop20 };
+enum ledState { off, on };
+enum axisType { xaxis, yaxis, zaxis };
+enum turnType { left, right };
+enum analogUnits { pct8 };
+
+#define PORT1 0
+#define PORT2 1
+#define PORT3 2
+#define PORT4 3
+#define PORT5 4
+#define PORT6 5
+#define PORT7 6
+#define PORT8 7
+#define PORT9 8
+#define PORT10 9
+#define PORT11 10
+#define PORT12 11
+#define PORT13 12
+#define PORT14 13
+#define PORT15 14
+#define PORT16 15
+#define PORT17 16
+#define PORT18 17
+#define PORT19 18
+#define PORT20 19
+
+class color {
+public:
+  uint32_t rgb;
+  color() : rgb(0) {}
+  color(int rgb) : rgb(rgb) {}
+  color(int r, int g, int b) : rgb(((r & 0xff) << 16) | ((g & 0xff) << 8) | (b & 0xff)) {}
+  bool operator==(const color& other) const { return rgb == other.rgb; }
+  bool operator!=(const color& other) const { return rgb != other.rgb; }
+  static const color red, blue, green, white, black, yellow, orange, purple, cyan, transparent;
+};
+extern const color black, white, red, green, blue, yellow, orange, purple, cyan, transparent;
+
+class device {
+public:
+  int32_t port;
+  bool hostInstalled = true;
+  device() : port(-1) {}
+  device(int32_t port) : port(port) {}
+  bool installed() { return hostInstalled; }
+  int32_t index() { return port; }
+};
+
+class motor : public device {
+public:
+  // The last command, and the readings the motor reports. Velocity is in deg/sec and position in deg.
+  double hostVoltage = 0;
+  double hostVelocity = 0;
+  double hostPosition = 0;
+  double hostCurrent = 0;
+  double hostTemperature = 25;
+  bool hostSpinning = false;
+  brakeType hostStopping = coast;
+
+  motor(int32_t port) : device(port) {}
+  motor(int32_t port, bool) : device(port) {}
+  motor(int32_t port, gearSetting, bool) : device(port) {}
+  void spin(directionType dir, double value, voltageUnits units) {
+    hostVoltage = (dir == reverse ? -value : value) / (units == voltageUnits_mV ? 1000 : 1);
+    hostSpinning = true;
+  }
+  void spin(directionType dir, double value, velocityUnits) { spin(dir, value * 0.12, volt); }
+  void spin(directionType) { hostSpinning = true; }
+  void stop() { stop(hostStopping); }
+  void stop(brakeType mode) { hostVoltage = 0; hostSpinning = false; hostStopping = mode; }
+  void setStopping(brakeType mode) { hostStopping = mode; }
+  void setVelocity(double, velocityUnits) {}
+  double position(rotationUnits units) { return units == rev ? hostPosition / 360 : hostPosition; }
+  void resetPosition() { hostPosition = 0; }
+  void setPosition(double value, rotationUnits units) { hostPosition = units == rev ? value * 360 : value; }
+  double velocity(velocityUnits units) { return units == dps ? hostVelocity : units == rpm ? hostVelocity / 6 : hostVelocity / 36; }
+  double current(currentUnits) { return hostCurrent; }
+  double current(percentUnits) { return hostCurrent / 2.5 * 100; }
+  double voltage(voltageUnits units) { return units == voltageUnits_mV ? hostVoltage * 1000 : hostVoltage; }
+  double torque(torqueUnits) { return 0; }
+  double temperature(temperatureUnits) { return hostTemperature; }
+  double temperature(percentUnits) { return hostTemperature; }
+  double efficiency(percentUnits) { return 100; }
+  double power(powerUnits) { return fabs(hostVoltage * hostCurrent); }
+  bool isSpinning() { return hostSpinning; }
+  bool isDone() { return !hostSpinning; }
+  void setMaxTorque(double, percentUnits) {}
+};
+
+class motor_group {
+private:
+  static const int MAX_MOTORS = 8;
+  motor* motors[MAX_MOTORS];
+  int motorCount = 0;
+  void add() {}
+  template<class... T> void add(motor& first, T&... rest) {
+    if (motorCount < MAX_MOTORS) motors[motorCount++] = &first;
+    add(rest...);
+  }
+  template<class... T> void add(motor_group& group, T&... rest) {
+    for (int i = 0; i < group.motorCount && motorCount < MAX_MOTORS; i++) motors[motorCount++] = group.motors[i];
+    add(rest...);
+  }
+
+public:
+  motor_group() {}
+  template<class... T> motor_group(T&... m) { add(m...); }
+  void spin(directionType dir, double value, voltageUnits units) { for (int i = 0; i < motorCount; i++) motors[i]->spin(dir, value, units); }
+  void spin(directionType dir) { for (int i = 0; i < motorCount; i++) motors[i]->spin(dir); }
+  void stop() { for (int i = 0; i < motorCount; i++) motors[i]->stop(); }
+  void stop(brakeType mode) { for (int i = 0; i < motorCount; i++) motors[i]->stop(mode); }
+  void setStopping(brakeType mode) { for (int i = 0; i < motorCount; i++) motors[i]->setStopping(mode); }
+  double position(rotationUnits units) { return motorCount > 0 ? motors[0]->position(units) : 0; }
+  void resetPosition() { for (int i = 0; i < motorCount; i++) motors[i]->resetPosition(); }
+  void setPosition(double value, rotationUnits units) { for (int i = 0; i < motorCount; i++) motors[i]->setPosition(value, units); }
+  double velocity(velocityUnits units) { return motorCount > 0 ? motors[0]->velocity(units) : 0; }
+  double current(currentUnits units) {
+    double total = 0;
+    for (int i = 0; i < motorCount; i++) total += motors[i]->current(units);
+    return total;
+  }
+  double temperature(temperatureUnits units) { return motorCount > 0 ? motors[0]->temperature(units) : 0; }
+  double voltage(voltageUnits units) { return motorCount > 0 ? motors[0]->voltage(units) : 0; }
+  int32_t count() { return motorCount; }
+};
+
+class inertial : public device {
+public:
+  // The heading in deg, not wrapped, and the pitch and roll.
+  double hostHeading = 0;
+  double hostPitch = 0;
+  double hostRoll = 0;
+  double hostRate = 0;
+
+  inertial(int32_t port) : device(port) {}
+  double heading() { return fmod(fmod(hostHeading, 360) + 360, 360); }
+  double heading(rotationUnits) { return heading(); }
+  double rotation() { return hostHeading; }
+  void setHeading(double value, rotationUnits) { hostHeading = value; }
+  void setRotation(double value, rotationUnits) { hostHeading = value; }
+  void calibrate() {}
+  void calibrate(int32_t) {}
+  bool isCalibrating() { return false; }
+  double pitch() { return hostPitch; }
+  double roll() { return hostRoll; }
+  double yaw() { return heading() > 180 ? heading() - 360 : heading(); }
+  double gyroRate(axisType, velocityUnits) { return hostRate; }
+  double acceleration(axisType) { return 0; }
+};
+
+class rotation : public device {
+public:
+  double hostAngle = 0;
+  double hostVelocity = 0;
+
+  rotation(int32_t port) : device(port) {}
+  rotation(int32_t port, bool) : device(port) {}
+  double angle(rotationUnits) { return fmod(fmod(hostAngle, 360) + 360, 360); }
+  double position(rotationUnits units) { return units == rev ? hostAngle / 360 : hostAngle; }
+  void resetPosition() { hostAngle = 0; }
+  void setPosition(double value, rotationUnits units) { hostAngle = units == rev ? value * 360 : value; }
+  double velocity(velocityUnits) { return hostVelocity; }
+};
+
+class optical : public device {
+public:
+  double hostHue = 0;
+  double hostBrightness = 0;
+  bool hostNear = false;
+  vex::color hostColor;
+
+  optical(int32_t port) : device(port) {}
+  double hue() { return hostHue; }
+  double brightness() { return hostBrightness; }
+  vex::color color() { return hostColor; }
+  bool isNearObject() { return hostNear; }
+  void setLight(ledState) {}
+  void setLightPower(double, percentUnits) {}
+  void integrationTime(double) {}
+  double integrationTime() { return 5; }
+  void objectDetectThreshold(int32_t) {}
+};
+
+class distance : public device {
+public:
+  // The distance to the object in mm, or a negative value if none is in range.
+  double hostDistance = -1;
+
+  distance(int32_t port) : device(port) {}
+  double objectDistance(distanceUnits units) {
+    if (hostDistance < 0) return 9999;
+    return units == inches ? hostDistance / 25.4 : units == cm ? hostDistance / 10 : hostDistance;
+  }
+  double objectVelocity() { return 0; }
+  bool isObjectDetected() { return hostDistance >= 0; }
+};
+
+class triport {
+public:
+  class port {};
+  port A, B, C, D, E, F, G, H;
+};
+
+class digital_out {
+public:
+  bool hostValue = false;
+  digital_out(triport::port&) {}
+  void set(bool value) { hostValue = value; }
+  bool value() { return hostValue; }
+};
+
+class timer {
+private:
+  uint64_t start;
+
+public:
+  timer() : start(host::clockMicros()) {}
+  double time(timeUnits units) { return (host::clockMicros() - start) / (units == msec ? 1000.0 : 1000000.0); }
+  double time() { return time(msec); }
+  void clear() { start = host::clockMicros(); }
+  void reset() { clear(); }
+  static uint32_t system() { return (uint32_t)(host::clockMicros() / 1000); }
+  static uint64_t systemHighResolution() { return host::clockMicros(); }
+};
+
+class brain {
+public:
+  // The screen draws nothing. Tools that look at the dashboard draw to a framebuffer instead.
+  class lcd {
+  public:
+    void print(const char*, ...) {}
+    void printAt(int32_t, int32_t, const char*, ...) {}
+    void printAt(int32_t, int32_t, bool, const char*, ...) {}
+    void clearScreen() {}
+    void clearScreen(const color&) {}
+    void clearLine(int32_t) {}
+    void clearLine() {}
+    void setCursor(int32_t, int32_t) {}
+    void newLine() {}
+    void setFont(fontType) {}
+    void setPenColor(const color&) {}
+    void setFillColor(const color&) {}
+    void setPenWidth(uint32_t) {}
+    void drawRectangle(int32_t, int32_t, int32_t, int32_t) {}
+    void drawRectangle(int32_t, int32_t, int32_t, int32_t, const color&) {}
+    void drawLine(int32_t, int32_t, int32_t, int32_t) {}
+    bool pressing() { return false; }
+    int32_t xPosition() { return 0; }
+    int32_t yPosition() { return 0; }
+    bool render() { return true; }
+    bool render(bool, bool) { return true; }
+    int32_t getStringWidth(const char*) { return 0; }
+    int32_t getStringHeight(const char*) { return 0; }
+    void pressed(void (*)()) {}
+  };
+  // The SD card is a directory on the host, see host::setSdRoot().
+  class sdcard {
+  public:
+    bool isInserted() { return true; }
+    int32_t loadfile(const char* name, uint8_t* buffer, int32_t size);
+    int32_t savefile(const char* name, uint8_t* buffer, int32_t size);
+    int32_t appendfile(const char* name, uint8_t* buffer, int32_t size);
+    int32_t size(const char* name);
+    bool exists(const char* name);
+  };
+  class battery {
+  public:
+    uint32_t capacity() { return 100; }
+    uint32_t capacity(percentUnits) { return 100; }
+    double voltage(voltageUnits) { return 12.8; }
+    double current(currentUnits) { return 0; }
+    double temperature(percentUnits) { return 25; }
+  };
+  lcd Screen;
+  sdcard SDcard;
+  timer Timer;
+  battery Battery;
+  triport ThreeWirePort;
+};
+
+class controller {
+public:
+  class button {
+  public:
+    bool hostPressing = false;
+    bool pressing() { return hostPressing; }
+    void pressed(void (*)()) {}
+    void released(void (*)()) {}
+  };
+  class axis {
+  public:
+    int32_t hostPosition = 0;
+    int32_t position() { return hostPosition; }
+    int32_t position(percentUnits) { return hostPosition; }
+    void changed(void (*)()) {}
+  };
+  class lcd {
+  public:
+    void print(const char*, ...) {}
+    void setCursor(int32_t, int32_t) {}
+    void clearScreen() {}
+    void clearLine(int32_t) {}
+    void clearLine() {}
+    void newLine() {}
+  };
+  button ButtonL1, ButtonL2, ButtonR1, ButtonR2, ButtonUp, ButtonDown, ButtonLeft, ButtonRight, ButtonX, ButtonB, ButtonY, ButtonA;
+  axis Axis1, Axis2, Axis3, Axis4;
+  lcd Screen;
+  controller() {}
+  controller(controllerType) {}
+  void rumble(const char*) {}
+  bool installed() { return true; }
+};
+
+class competition {
+public:
+  void autonomous(void (*)()) {}
+  void drivercontrol(void (*)()) {}
+  bool isEnabled() { return false; }
+  bool isAutonomous() { return false; }
+  bool isDriverControl() { return false; }
+  bool isCompetitionSwitch() { return false; }
+  bool isFieldControl() { return false; }
+};
+
+// Threads run detached on the host, and the priorities are ignored.
+class thread {
+public:
+  static const int32_t threadPriorityLow = 1;
+  static const int32_t threadPriorityNormal = 7;
+  static const int32_t threadPriorityHigh = 15;
+  thread() {}
+  thread(int (*callback)());
+  thread(void (*callback)());
+  thread(int (*callback)(void*), void* arg);
+  void join() {}
+  void detach() {}
+  void interrupt() {}
+  void setPriority(int32_t) {}
+  int32_t priority() { return threadPriorityNormal; }
+};
+
+class task {
+public:
+  static const int32_t taskPriorityLow = 1;
+  static const int32_t taskPriorityNormal = 7;
+  static const int32_t taskPriorityHigh = 15;
+  task() {}
+  task(int (*callback)()) { thread run(callback); }
+  task(int (*callback)(), int32_t) { thread run(callback); }
+  task(int (*callback)(void*), void* arg) { thread run(callback, arg); }
+  task(int (*callback)(void*), void* arg, int32_t) { thread run(callback, arg); }
+  void stop() {}
+  void suspend() {}
+  void resume() {}
+  void setPriority(int32_t) {}
+};
+
+class mutex {
+private:
+  std::mutex lock_;
+
+public:
+  mutex() {}
+  void lock() { lock_.lock(); }
+  bool try_lock() { return lock_.try_lock(); }
+  void unlock() { lock_.unlock(); }
+};
+
+namespace this_thread {
+  void sleep_for(uint32_t time);
+  void sleep_until(uint32_t time);
+  void yield();
+  int32_t get_id();
+}
+
+void wait(double time, timeUnits units);
+}
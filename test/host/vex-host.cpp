@@ -0,0 +1,173 @@
+// The host implementation of the parts of the VEX SDK that are not inline in v5_vcs.h.
+#include "vex.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+
+namespace vex {
+const color color::red(0xff0000), color::blue(0x0000ff), color::green(0x00ff00), color::white(0xffffff),
+  color::black(0x000000), color::yellow(0xffff00), color::orange(0xffa500), color::purple(0xff00ff),
+  color::cyan(0x00ffff), color::transparent(-1);
+const color black = color::black, white = color::white, red = color::red, green = color::green, blue = color::blue,
+  yellow = color::yellow, orange = color::orange, purple = color::purple, cyan = color::cyan,
+  transparent = color::transparent;
+}
+
+namespace {
+// The manual clock in usec, and whether it is in use. The thread that switched to it moves it on when it
+// waits; every other thread waits until the clock reaches the end of its wait.
+std::atomic<bool> manualClock(false);
+std::atomic<uint64_t> manualTime(0);
+std::thread::id clockOwner;
+std::mutex clockLock;
+std::condition_variable clockMoved;
+void (*waitHook)() = nullptr;
+char sdRoot[256] = ".";
+
+uint64_t realMicros() {
+  static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+// Waits until the clock reads a time in usec.
+void sleepUntilMicros(uint64_t time) {
+  if (!manualClock) {
+    uint64_t now = realMicros();
+    if (time > now) std::this_thread::sleep_for(std::chrono::microseconds(time - now));
+    return;
+  }
+  if (std::this_thread::get_id() == clockOwner) {
+    if (waitHook != nullptr) waitHook();
+    if (time > manualTime) host::advanceClock((time - manualTime) / 1000.0);
+    std::this_thread::yield();
+    return;
+  }
+  std::unique_lock<std::mutex> lock(clockLock);
+  clockMoved.wait(lock, [time] { return manualTime >= time; });
+}
+
+// Returns the path of a file on the SD card.
+void sdPath(const char* name, char* path, int size) {
+  snprintf(path, size, "%s/%s", sdRoot, name);
+}
+}
+
+namespace host {
+void useManualClock() {
+  manualTime = realMicros();
+  clockOwner = std::this_thread::get_id();
+  manualClock = true;
+}
+
+void advanceClock(double time) {
+  {
+    std::lock_guard<std::mutex> lock(clockLock);
+    manualTime += (uint64_t)(time * 1000);
+  }
+  clockMoved.notify_all();
+}
+
+void onWait(void (*hook)()) {
+  waitHook = hook;
+}
+
+void setSdRoot(const char* path) {
+  snprintf(sdRoot, sizeof(sdRoot), "%s", path);
+}
+
+uint64_t clockMicros() {
+  return manualClock ? manualTime.load() : realMicros();
+}
+
+void sleepMillis(double time) {
+  sleepUntilMicros(clockMicros() + (uint64_t)(time * 1000));
+}
+}
+
+namespace vex {
+int32_t brain::sdcard::loadfile(const char* name, uint8_t* buffer, int32_t size) {
+  char path[512];
+  sdPath(name, path, sizeof(path));
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) return 0;
+  int32_t length = fread(buffer, 1, size, file);
+  fclose(file);
+  return length;
+}
+
+int32_t brain::sdcard::savefile(const char* name, uint8_t* buffer, int32_t size) {
+  char path[512];
+  sdPath(name, path, sizeof(path));
+  FILE* file = fopen(path, "wb");
+  if (file == nullptr) return 0;
+  int32_t length = fwrite(buffer, 1, size, file);
+  fclose(file);
+  return length;
+}
+
+int32_t brain::sdcard::appendfile(const char* name, uint8_t* buffer, int32_t size) {
+  char path[512];
+  sdPath(name, path, sizeof(path));
+  FILE* file = fopen(path, "ab");
+  if (file == nullptr) return 0;
+  int32_t length = fwrite(buffer, 1, size, file);
+  fclose(file);
+  return length;
+}
+
+int32_t brain::sdcard::size(const char* name) {
+  char path[512];
+  sdPath(name, path, sizeof(path));
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) return 0;
+  fseek(file, 0, SEEK_END);
+  int32_t length = ftell(file);
+  fclose(file);
+  return length;
+}
+
+bool brain::sdcard::exists(const char* name) {
+  char path[512];
+  sdPath(name, path, sizeof(path));
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) return false;
+  fclose(file);
+  return true;
+}
+
+thread::thread(int (*callback)()) {
+  std::thread(callback).detach();
+}
+
+thread::thread(void (*callback)()) {
+  std::thread(callback).detach();
+}
+
+thread::thread(int (*callback)(void*), void* arg) {
+  std::thread(callback, arg).detach();
+}
+
+namespace this_thread {
+void sleep_for(uint32_t time) {
+  host::sleepMillis(time);
+}
+
+void sleep_until(uint32_t time) {
+  sleepUntilMicros((uint64_t)time * 1000);
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+int32_t get_id() {
+  return (int32_t)(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0x7fffffff);
+}
+}
+
+void wait(double time, timeUnits units) {
+  host::sleepMillis(units == msec ? time : time * 1000);
+}
+}
@@ -0,0 +1,83 @@
+// Runs the motion benchmark on the host and fails if a maneuver regressed against the baseline.
+// Usage: bench <results.csv> <baseline.csv>
+#include "benchmark.h"
+
+// A maneuver regresses when it takes 5% longer, overshoots 0.5 inch or degree more, settles 5 ticks
+// slower, or its control code takes 50% more CPU time per tick than in the baseline. The CPU time is
+// the thread's own, but it still varies with the host's load and clock speed.
+MotionBenchmark motionBenchmark(benchmarkModel, {0.05, 0.5, 5, 0.5}, runBenchmarkAuton);
+// A chain of two drives that hand their speed over at a 30 degree corner, then a turn.
+const ChainSegment benchmarkChain[] = {
+  {CHAIN_DRIVE, 24, 0, 40, 80},
+  {CHAIN_DRIVE, 24, 30, 40, 80},
+  {CHAIN_TURN, 90}
+};
+// Paired routes that take the same corner with a pivot and with a swing or an arc, so the time a swing
+// or arc saves is measured on the same moves. The first pair backs up, turns and drives forward, as
+// sampleAuton2 does; the second drives around a corner to the same end point.
+void backPivotForward() {
+  chassis.driveDistance(-24);
+  chassis.turnToHeading(90);
+  chassis.driveDistance(24);
+}
+
+void backSwingForward() {
+  chassis.driveDistance(-24);
+  chassis.swingToHeading(90, SWING_LEFT);
+  chassis.driveDistance(24);
+}
+
+void cornerPivot() {
+  chassis.driveDistance(24);
+  chassis.turnToHeading(90);
+  chassis.driveDistance(24);
+}
+
+void cornerArc() {
+  chassis.driveDistance(12);
+  chassis.driveArc(12, 90);
+  chassis.driveDistance(12);
+}
+
+// The canonical maneuvers of the benchmark. Autons are given by their menu index.
+const BenchmarkManeuver benchmarkManeuvers[] = {
+  {"drive_6", BENCH_DRIVE, 6},
+  {"drive_48", BENCH_DRIVE, 48},
+  {"turn_15", BENCH_TURN, 15},
+  {"turn_90", BENCH_TURN, 90},
+  {"turn_180", BENCH_TURN, 180},
+  // Every turn size from 5 to 180 deg, across all rows of the turn schedule, and again with the single
+  // set of turn PID constants, to measure what the schedule saves.
+  {"turn_sweep", BENCH_TURN_SWEEP, 5},
+  {"turn_sweep_pid", BENCH_TURN_SWEEP_PID, 5},
+  {"swing_90", BENCH_SWING, 90},
+  {"arc_24_90", BENCH_ARC, 90, nullptr, 24},
+  {"chain_48", BENCH_CHAIN, 3, benchmarkChain},
+  // The same segments, each stopping before the next starts, to measure what chaining saves.
+  {"chain_48_unchained", BENCH_UNCHAINED, 3, benchmarkChain},
+  // The arcade control released at 10, 30 and 60 inch/sec, for the active brake's stopping distance.
+  {"stop_10", BENCH_STOP, 10},
+  {"stop_30", BENCH_STOP, 30},
+  {"stop_60", BENCH_STOP, 60},
+  {"back_pivot_fwd", BENCH_ROUTE, 0, nullptr, 0, backPivotForward},
+  {"back_swing_fwd", BENCH_ROUTE, 0, nullptr, 0, backSwingForward},
+  {"corner_pivot", BENCH_ROUTE, 0, nullptr, 0, cornerPivot},
+  {"corner_arc", BENCH_ROUTE, 0, nullptr, 0, cornerArc},
+  {"auton2", BENCH_AUTON, 1},
+  {"auton_skill", BENCH_AUTON, 2},
+};
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    printf("usage: %s <results.csv> <baseline.csv>\n", argv[0]);
+    return 2;
+  }
+  // The maneuvers run on the constants in setChassisDefaults() alone, not on a measured model.
+  setChassisDefaults();
+  // The stops run under the acceleration limits of the first drive mode, an arcade.
+  driveModes.select(0);
+  int regressions = motionBenchmark.run(benchmarkManeuvers, sizeof(benchmarkManeuvers) / sizeof(benchmarkManeuvers[0]),
+                                        argv[1], argv[2]);
+  motionBenchmark.printResults();
+  return regressions > 0 ? 1 : 0;
+}
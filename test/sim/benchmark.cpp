@@ -0,0 +1,206 @@
+#include "benchmark.h"
+#include <time.h>
+
+MotionBenchmark::MotionBenchmark(const DriveModel& model, const BenchmarkThresholds& thresholds, void (*runAuton)(int selection)) :
+  model(model),
+  thresholds(thresholds),
+  runAuton(runAuton) {
+  simulation.setClock(threadCpuTime);
+}
+
+uint64_t MotionBenchmark::threadCpuTime() {
+  timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+int MotionBenchmark::runStop(float speed) {
+  // Full stick forward until the robot reaches the speed, through the drive mode's acceleration limits.
+  for (int i = 0; i < 500 && simulation.getLeftVelocity() < speed; i++) {
+    chassis.controlArcade(100, 0);
+    simulation.step();
+  }
+  // The stopping distance is tracked from the release. The brake runs for a second, past its hold time,
+  // so the distance includes any roll after the brake lets go.
+  simulation.setTarget(false, 0);
+  int stopTicks = -1;
+  for (int i = 0; i < 100; i++) {
+    chassis.controlArcade(0, 0);
+    simulation.step();
+    if (stopTicks < 0 && fabsf(simulation.getLeftVelocity()) < 0.5f) stopTicks = i + 1;
+  }
+  return stopTicks < 0 ? 100 : stopTicks;
+}
+
+BenchmarkResult MotionBenchmark::runManeuver(const BenchmarkManeuver& maneuver) {
+  BenchmarkResult result;
+  snprintf(result.name, sizeof(result.name), "%s", maneuver.name);
+  result.regressed = false;
+  if (maneuver.motion == BENCH_TURN_SWEEP || maneuver.motion == BENCH_TURN_SWEEP_PID) {
+    // Each turn of the sweep starts at rest from 0, so each one exercises a different row of the turn schedule.
+    result.time = 0;
+    result.overshoot = 0;
+    result.settleTicks = 0;
+    float cpuTime = 0;
+    int ticks = 0;
+    for (float heading = maneuver.target; heading <= 180; heading += maneuver.target) {
+      BenchmarkManeuver turn = {maneuver.name, maneuver.motion == BENCH_TURN_SWEEP ? BENCH_TURN : BENCH_TURN_PID, heading};
+      BenchmarkResult turnResult = runManeuver(turn);
+      result.time += turnResult.time;
+      result.overshoot = fmaxf(result.overshoot, turnResult.overshoot);
+      if (turnResult.settleTicks > result.settleTicks) result.settleTicks = turnResult.settleTicks;
+      cpuTime += turnResult.tickCpuTime * turnResult.time / 10;
+      ticks += turnResult.time / 10;
+    }
+    result.tickCpuTime = ticks > 0 ? cpuTime / ticks : 0;
+    return result;
+  }
+
+  // Every maneuver starts from the same settings and at rest, so the results do not depend on the order.
+  setChassisDefaults();
+  simulation.reset(model);
+  chassis.setSimulation(&simulation);
+  chassis.setHeading(0);
+  int stopTicks = 0;
+  switch (maneuver.motion) {
+  case BENCH_DRIVE:
+    simulation.setTarget(false, maneuver.target);
+    chassis.driveDistance(maneuver.target);
+    break;
+  case BENCH_TURN:
+  case BENCH_TURN_PID:
+    if (maneuver.motion == BENCH_TURN_PID) chassis.setTurnSchedule(nullptr, 0);
+    // Turning to 180 from 0 goes the short way round, which is counterclockwise.
+    simulation.setTarget(true, wrap180(maneuver.target));
+    chassis.turnToHeading(maneuver.target);
+    break;
+  case BENCH_SWING:
+    // Turning right drives the left side and holds the right, and the other way round.
+    simulation.setTarget(true, wrap180(maneuver.target));
+    chassis.swingToHeading(maneuver.target, wrap180(maneuver.target) > 0 ? SWING_LEFT : SWING_RIGHT);
+    break;
+  case BENCH_ARC:
+    simulation.setTarget(true, maneuver.target);
+    chassis.driveArc(maneuver.radius, maneuver.target);
+    break;
+  case BENCH_CHAIN:
+  case BENCH_UNCHAINED: {
+    // Turns in place do not move the average position, so the chain is tracked over the sum of its drives.
+    float distance = 0;
+    for (int i = 0; i < maneuver.target; i++) {
+      if (maneuver.chain[i].motion == CHAIN_DRIVE) distance += maneuver.chain[i].target;
+    }
+    simulation.setTarget(false, distance);
+    if (maneuver.motion == BENCH_CHAIN) {
+      chassis.driveChain(maneuver.chain, maneuver.target);
+    } else {
+      // A chain of one segment plans it to start and end at rest, on the same profile as in the full chain.
+      for (int i = 0; i < maneuver.target; i++) chassis.driveChain(&maneuver.chain[i], 1);
+    }
+    break;
+  }
+  case BENCH_STOP:
+    stopTicks = runStop(maneuver.target);
+    break;
+  case BENCH_ROUTE:
+    maneuver.route();
+    break;
+  case BENCH_AUTON:
+    runAuton(maneuver.target);
+    break;
+  default:
+    break;
+  }
+  chassis.setSimulation(nullptr);
+  robotState.drivetrainNeedsStopped = false;
+
+  if (maneuver.motion == BENCH_STOP) {
+    result.time = stopTicks * 10;
+    result.overshoot = simulation.getOvershoot();
+    result.settleTicks = 0;
+  } else {
+    result.time = simulation.getTicks() * 10;
+    result.overshoot = simulation.getOvershoot();
+    result.settleTicks = simulation.getSettleTicks();
+  }
+  result.tickCpuTime = simulation.getTickCpuTime();
+  return result;
+}
+
+bool MotionBenchmark::compareBaseline(const char* fileName) {
+  FILE* file = fopen(fileName, "r");
+  if (file == nullptr) return false;
+  // Skips the header, then matches each row with the result of the same name.
+  char line[128];
+  fgets(line, sizeof(line), file);
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    char name[24];
+    float time, overshoot, tickCpuTime;
+    int settleTicks;
+    if (sscanf(line, "%23[^,],%f,%f,%d,%f", name, &time, &overshoot, &settleTicks, &tickCpuTime) != 5) continue;
+    for (int i = 0; i < resultCount; i++) {
+      BenchmarkResult& result = results[i];
+      if (strcmp(result.name, name) != 0) continue;
+      result.regressed = result.time > time * (1 + thresholds.timeShare)
+        || result.overshoot > overshoot + thresholds.overshoot
+        || result.settleTicks > settleTicks + thresholds.settleTicks
+        || result.tickCpuTime > tickCpuTime * (1 + thresholds.cpuShare);
+    }
+  }
+  fclose(file);
+  return true;
+}
+
+bool MotionBenchmark::saveResults(const char* fileName) {
+  FILE* file = fopen(fileName, "w");
+  if (file == nullptr) return false;
+  fprintf(file, "maneuver,time,overshoot,settleTicks,tickCpu,regressed\n");
+  for (int i = 0; i < resultCount; i++) {
+    const BenchmarkResult& result = results[i];
+    fprintf(file, "%s,%.0f,%.2f,%d,%.2f,%d\n", result.name, result.time, result.overshoot,
+            result.settleTicks, result.tickCpuTime, result.regressed ? 1 : 0);
+  }
+  return fclose(file) == 0;
+}
+
+int MotionBenchmark::run(const BenchmarkManeuver* maneuvers, int maneuverCount, const char* resultFile, const char* baselineFile) {
+  resultCount = 0;
+  regressionCount = 0;
+  for (int i = 0; i < maneuverCount && resultCount < MAX_RESULTS; i++) {
+    BenchmarkResult result = runManeuver(maneuvers[i]);
+    // The simulated metrics are the same on every run, but the CPU time is not. The fastest of several runs
+    // is the one least disturbed by the rest of the host.
+    for (int repeat = 1; repeat < CPU_REPEATS; repeat++) {
+      result.tickCpuTime = fminf(result.tickCpuTime, runManeuver(maneuvers[i]).tickCpuTime);
+    }
+    results[resultCount++] = result;
+  }
+
+  if (!compareBaseline(baselineFile)) {
+    saveResults(baselineFile);
+    printf("no baseline, saved these results as %s\n", baselineFile);
+  }
+  for (int i = 0; i < resultCount; i++) {
+    if (results[i].regressed) regressionCount++;
+  }
+  if (!saveResults(resultFile)) printf("could not write %s\n", resultFile);
+  return regressionCount;
+}
+
+void MotionBenchmark::printResults() {
+  printf("%-24s %8s %10s %7s %9s\n", "maneuver", "time ms", "overshoot", "settle", "tick cpu");
+  for (int i = 0; i < resultCount; i++) {
+    const BenchmarkResult& result = results[i];
+    printf("%-24s %8.0f %10.2f %7d %7.2fus%s\n", result.name, result.time, result.overshoot, result.settleTicks,
+           result.tickCpuTime, result.regressed ? "  REGRESSED" : "");
+  }
+  printf("%d of %d maneuvers regressed\n", regressionCount, resultCount);
+}
+
+const BenchmarkResult* MotionBenchmark::getResults() {
+  return results;
+}
+
+int MotionBenchmark::getResultCount() {
+  return resultCount;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "vex.h"
+
+// The kinds of benchmark maneuvers.
+enum benchmarkMotion {
+  BENCH_DRIVE,  // drives a distance in inches
+  BENCH_TURN,   // turns to a heading in degrees from 0
+  BENCH_TURN_SWEEP,  // turns from 0 to every heading up to 180 degrees, in steps of the target in degrees
+  BENCH_TURN_PID,    // turns to a heading in degrees from 0 with the single set of turn PID constants, without the turn schedule
+  BENCH_TURN_SWEEP_PID,  // the sweep of BENCH_TURN_SWEEP made of BENCH_TURN_PID turns
+  BENCH_SWING,  // swing turns to a heading in degrees from 0
+  BENCH_ARC,    // drives an arc of a radius in inches, turning by the target in degrees
+  BENCH_CHAIN,  // runs a chain of target segments from a heading of 0
+  BENCH_UNCHAINED,  // runs each of the target segments of a chain as a chain of its own, so each one stops
+  BENCH_STOP,   // drives arcade at full stick to the target speed in inch/sec, then releases the sticks
+  BENCH_ROUTE,  // runs a route of chassis motions from a heading of 0
+  BENCH_AUTON   // runs the auton at a menu index
+};
+
+// A maneuver of the benchmark.
+struct BenchmarkManeuver
+{
+  const char* name;
+  benchmarkMotion motion;
+  // The distance, heading, sweep step, chain segment count, release speed or auton index.
+  float target;
+  // The segments of a chain or an unchained chain. Unused by the other maneuvers.
+  const ChainSegment* chain;
+  // The radius of an arc in inches. Unused by the other maneuvers.
+  float radius;
+  // Runs the motions of a route. Unused by the other maneuvers.
+  void (*route)();
+};
+
+// The results of a maneuver.
+struct BenchmarkResult
+{
+  char name[24];
+  // The simulated time in msec until the maneuver returned, summed over the turns of a sweep. For stops,
+  // the time from releasing the sticks until the robot came to rest.
+  float time;
+  // The distance in inches or angle in deg past the target, the worst of a sweep. For chains, chained or
+  // not, the distance past the total of their drives. For stops, the distance rolled after releasing the sticks. 0 for routes and autons.
+  float overshoot;
+  // The ticks from first reaching the target until the motion ended, the worst of a sweep. 0 for stops, routes and autons.
+  int settleTicks;
+  // The time in usec the control code ran per tick.
+  float tickCpuTime;
+  // Whether a metric regressed past its threshold against the baseline.
+  bool regressed;
+};
+
+// How far each metric may get worse than the baseline before it counts as a regression.
+struct BenchmarkThresholds
+{
+  // The share the time may grow by, e.g. 0.05 for 5%.
+  float timeShare;
+  // The inches or degrees the overshoot may grow by.
+  float overshoot;
+  // The ticks the settle time may grow by.
+  int settleTicks;
+  // The share the CPU time per tick may grow by. It varies from run to run, so allow more.
+  float cpuShare;
+};
+
+// A class to run a fixed set of maneuvers on a simulated drivetrain and catch regressions in the
+// motion code. The results are written to a CSV file and compared with a baseline file of the same
+// format. If there is no baseline, the results become the baseline. Copy the results over the
+// baseline to accept them.
+class MotionBenchmark
+{
+private:
+  // The most maneuvers in one run.
+  static const int MAX_RESULTS = 32;
+  // The runs of each maneuver its CPU time is the best of.
+  static const int CPU_REPEATS = 5;
+
+  // The plant the maneuvers run on.
+  DriveModel model;
+  DriveSimulation simulation;
+  // The regression thresholds.
+  BenchmarkThresholds thresholds;
+  // Runs the auton at a menu index.
+  void (*runAuton)(int selection);
+
+  // The results of the last run.
+  BenchmarkResult results[MAX_RESULTS];
+  int resultCount = 0;
+  int regressionCount = 0;
+
+  // Returns the CPU time in nsec of the calling thread, which the simulation times the control code on.
+  static uint64_t threadCpuTime();
+  // Runs one maneuver on the simulation.
+  BenchmarkResult runManeuver(const BenchmarkManeuver& maneuver);
+  // Drives the arcade control to a speed and releases the sticks. Returns the ticks from the release
+  // until the robot came to rest.
+  int runStop(float speed);
+  // Marks the results that regressed against the baseline file. Returns false if there is no baseline.
+  bool compareBaseline(const char* fileName);
+  // Writes the results as CSV. Returns false if they could not be written.
+  bool saveResults(const char* fileName);
+
+public:
+  // The constructor for the MotionBenchmark class.
+  MotionBenchmark(const DriveModel& model, const BenchmarkThresholds& thresholds, void (*runAuton)(int selection));
+
+  // Runs the maneuvers, compares them with the baseline file and saves the results to the result file.
+  // Returns the number of maneuvers that regressed.
+  int run(const BenchmarkManeuver* maneuvers, int maneuverCount, const char* resultFile, const char* baselineFile);
+  // Prints the results of the last run, marking the ones that regressed.
+  void printResults();
+  // Returns the results of the last run.
+  const BenchmarkResult* getResults();
+  int getResultCount();
+};
@@ -0,0 +1,136 @@
+// Feeds ColorSort a synthetic stream of red and blue objects at several roller speeds on the host and
+// reports the throughput and the misfires: opponent objects that were scored and own objects that were
+// ejected.
+// Usage: color-sort [spacing deg] [objects]
+#include "vex.h"
+
+// The sampling period of the sort task in msec.
+const int SAMPLE_MS = 5;
+// The roller travel in deg an object stays in front of the sensor.
+const float OBJECT_LENGTH_DEG = 120;
+// The most objects in one run.
+const int MAX_OBJECTS = 1000;
+
+// An object in the stream.
+struct StreamObject
+{
+  bool red;
+  // The roller position where its front reaches the sensor.
+  float entry;
+  bool ejected;
+};
+
+// The eject timing the sorter runs with, matching ColorSort's defaults.
+const float EJECT_TRAVEL_DEG = 360;
+const float EJECT_LATENCY = 20;
+const float EJECT_TIME = 150;
+
+// When the last eject was commanded and ended, in msec.
+float ejectStart = -1;
+float ejectEnd = -1;
+
+void recordEject(bool eject) {
+  float now = timer::system();
+  if (eject) {
+    ejectStart = now;
+    ejectEnd = -1;
+  } else {
+    ejectEnd = now;
+  }
+}
+
+// Returns whether the eject acts at a time: from the actuation latency after it was commanded until it ends.
+bool ejectActs(float time) {
+  if (ejectStart < 0 || time < ejectStart + EJECT_LATENCY) return false;
+  return ejectEnd < 0 || time < ejectEnd;
+}
+
+// The result of a run at one roller speed.
+struct SortRun
+{
+  float throughput;
+  int opponents;
+  int opponentsScored;
+  int ownEjected;
+};
+
+// Runs the stream through a new sorter with the rollers at a speed in rpm. The eject is modeled as a gate
+// at the eject point that acts while ejectActs() is true; the rollers keep turning forward throughout.
+SortRun runStream(StreamObject* objects, int objectCount, float rpm) {
+  optical sensor(PORT1);
+  motor roller(PORT2);
+  ColorSort sorter(sensor, roller, recordEject);
+  sorter.setEjectTiming(EJECT_TRAVEL_DEG, EJECT_LATENCY, EJECT_TIME);
+  ejectStart = -1;
+  ejectEnd = -1;
+  for (int i = 0; i < objectCount; i++) objects[i].ejected = false;
+
+  float speed = rpm * 6;
+  roller.hostVelocity = speed;
+  int passed = 0;
+  while (passed < objectCount) {
+    host::advanceClock(SAMPLE_MS);
+    roller.hostPosition += speed * SAMPLE_MS / 1000;
+    float position = roller.hostPosition;
+
+    // The sensor sees the object whose body is in front of it.
+    sensor.hostNear = false;
+    for (int i = passed; i < objectCount && objects[i].entry <= position; i++) {
+      if (position < objects[i].entry + OBJECT_LENGTH_DEG) {
+        sensor.hostNear = true;
+        // Hue jitters by up to 10 deg around the middle of each color's range.
+        float jitter = 20.0f * rand() / RAND_MAX - 10;
+        sensor.hostHue = objects[i].red ? fmodf(360 + jitter, 360) : 220 + jitter;
+      }
+    }
+    sorter.update();
+
+    // Objects that reached the eject point are ejected if the gate acts now, and scored otherwise.
+    float now = timer::system();
+    while (passed < objectCount && objects[passed].entry + EJECT_TRAVEL_DEG <= position) {
+      objects[passed].ejected = ejectActs(now);
+      passed++;
+    }
+  }
+
+  SortRun run = {sorter.getThroughput(), 0, 0, 0};
+  for (int i = 0; i < objectCount; i++) {
+    bool opponent = robotState.teamIsRed ? !objects[i].red : objects[i].red;
+    if (opponent) run.opponents++;
+    if (opponent && !objects[i].ejected) run.opponentsScored++;
+    if (!opponent && objects[i].ejected) run.ownEjected++;
+  }
+  return run;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 3) {
+    printf("usage: %s [spacing deg] [objects]\n", argv[0]);
+    return 2;
+  }
+  float spacing = argc > 1 ? atof(argv[1]) : 540;
+  int objectCount = argc > 2 ? atoi(argv[2]) : 200;
+  if (spacing < OBJECT_LENGTH_DEG || objectCount < 2 || objectCount > MAX_OBJECTS) {
+    printf("the spacing must be at least %.0f deg and the objects between 2 and %d\n", OBJECT_LENGTH_DEG, MAX_OBJECTS);
+    return 2;
+  }
+
+  // A third of the stream is the opponent's color, in the same order on every run.
+  static StreamObject objects[MAX_OBJECTS];
+  srand(1);
+  for (int i = 0; i < objectCount; i++) {
+    objects[i].red = rand() % 3 != 0;
+    objects[i].entry = (i + 1) * spacing;
+  }
+  robotState.teamIsRed = true;
+  host::useManualClock();
+
+  float speeds[] = {100, 200, 400, 600};
+  printf("%d objects %.0f deg apart:\n", objectCount, spacing);
+  printf("%8s %12s %10s %16s %12s\n", "rpm", "objects/s", "opponents", "opponents scored", "own ejected");
+  for (int i = 0; i < 4; i++) {
+    SortRun run = runStream(objects, objectCount, speeds[i]);
+    printf("%8.0f %12.2f %10d %16d %12d\n", speeds[i], run.throughput, run.opponents, run.opponentsScored, run.ownEjected);
+  }
+  return 0;
+}
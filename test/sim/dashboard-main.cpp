@@ -0,0 +1,80 @@
+// Renders the brain screen dashboard to a framebuffer on the host and reports what a frame costs, both
+// redrawing only the widgets that changed and redrawing all of them.
+// Usage: dashboard [frames] [screen.pgm]
+#include "framebuffer.h"
+#include <chrono>
+
+// The cost of a run of frames.
+struct RenderCost
+{
+  double meanTime;
+  double maxTime;
+  double widgetsPerFrame;
+  double pixelsPerFrame;
+};
+
+// The drivetrain the heading and distance widgets read.
+DriveSimulation simulation;
+
+// Renders frames while the robot drives an arc, redrawing every widget each frame if fullRedraw.
+RenderCost renderFrames(Framebuffer& framebuffer, int frameCount, bool fullRedraw) {
+  // Every run starts from rest and a blank screen.
+  simulation.reset(benchmarkModel);
+  simulation.setVoltage(8, 4);
+  framebuffer.clear();
+  dashboard.invalidate();
+  dashboard.renderFrame();
+  dashboard.resetStats();
+  framebuffer.resetStats();
+
+  double totalTime = 0;
+  double maxTime = 0;
+  for (int i = 0; i < frameCount; i++) {
+    // A frame every 50 msec, so the heading and distance widgets change on most frames.
+    for (int tick = 0; tick < 5; tick++) simulation.step();
+    if (fullRedraw) dashboard.invalidate();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    dashboard.renderFrame();
+    double time = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    totalTime += time;
+    if (time > maxTime) maxTime = time;
+  }
+  RenderCost cost;
+  cost.meanTime = totalTime / frameCount;
+  cost.maxTime = maxTime;
+  cost.widgetsPerFrame = (double)dashboard.getWidgetsRedrawn() / frameCount;
+  cost.pixelsPerFrame = (double)framebuffer.getPixelsWritten() / frameCount;
+  return cost;
+}
+
+void printCost(const char* name, const RenderCost& cost) {
+  printf("%-12s %9.2f %9.2f %9.2f %10.0f\n", name, cost.meanTime, cost.maxTime, cost.widgetsPerFrame, cost.pixelsPerFrame);
+}
+
+int main(int argc, char** argv) {
+  if (argc > 3) {
+    printf("usage: %s [frames] [screen.pgm]\n", argv[0]);
+    return 2;
+  }
+  int frameCount = argc > 1 ? atoi(argv[1]) : 1000;
+  const char* fileName = argc > 2 ? argv[2] : "dashboard.pgm";
+  if (frameCount <= 0) {
+    printf("frames must be positive\n");
+    return 2;
+  }
+
+  Framebuffer framebuffer;
+  dashboard.setCanvas(framebuffer.canvas());
+  chassis.setSimulation(&simulation);
+  RenderCost full = renderFrames(framebuffer, frameCount, true);
+  RenderCost changed = renderFrames(framebuffer, frameCount, false);
+  chassis.setSimulation(nullptr);
+  robotState.drivetrainNeedsStopped = false;
+
+  printf("%d frames, per frame:\n", frameCount);
+  printf("%-12s %9s %9s %9s %10s\n", "redraw", "mean us", "max us", "widgets", "pixels");
+  printCost("all", full);
+  printCost("changed", changed);
+  if (!framebuffer.save(fileName)) printf("could not write %s\n", fileName);
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include "framebuffer.h"
+
+Framebuffer::Framebuffer() {
+  memset(pixels, 0, sizeof(pixels));
+}
+
+void Framebuffer::fill(int x, int y, int width, int height, uint8_t level) {
+  int left = x < 0 ? 0 : x;
+  int top = y < 0 ? 0 : y;
+  int right = x + width > WIDTH ? WIDTH : x + width;
+  int bottom = y + height > HEIGHT ? HEIGHT : y + height;
+  for (int row = top; row < bottom; row++) {
+    for (int column = left; column < right; column++) pixels[row * WIDTH + column] = level;
+  }
+  if (right > left && bottom > top) pixelsWritten += (long)(right - left) * (bottom - top);
+}
+
+void Framebuffer::cellSize(fontType font, int& width, int& height) {
+  switch (font) {
+  case mono12: width = 6; height = 12; break;
+  case mono15: width = 8; height = 15; break;
+  case mono30: width = 15; height = 30; break;
+  case mono40: width = 20; height = 40; break;
+  default: width = 10; height = 20; break;
+  }
+}
+
+void Framebuffer::clearTarget(void* target) {
+  static_cast<Framebuffer*>(target)->clear();
+}
+
+void Framebuffer::clearBoxTarget(void* target, int x, int y, int width, int height) {
+  static_cast<Framebuffer*>(target)->clearBox(x, y, width, height);
+}
+
+void Framebuffer::printTextTarget(void* target, int x, int y, fontType font, const char* text) {
+  static_cast<Framebuffer*>(target)->printText(x, y, font, text);
+}
+
+DashboardCanvas Framebuffer::canvas() {
+  DashboardCanvas canvas = {this, clearTarget, clearBoxTarget, printTextTarget};
+  return canvas;
+}
+
+void Framebuffer::clear() {
+  fill(0, 0, WIDTH, HEIGHT, 0);
+}
+
+void Framebuffer::clearBox(int x, int y, int width, int height) {
+  fill(x, y, width, height, 0);
+}
+
+void Framebuffer::printText(int x, int y, fontType font, const char* text) {
+  int width, height;
+  cellSize(font, width, height);
+  // The cell sits on the baseline, with a pixel of space around it so the characters stay apart.
+  int capHeight = height * 7 / 10;
+  for (int i = 0; text[i] != '\0'; i++) {
+    if (text[i] != ' ') fill(x + i * width + 1, y - capHeight, width - 2, capHeight, 255);
+  }
+}
+
+long Framebuffer::getPixelsWritten() {
+  return pixelsWritten;
+}
+
+void Framebuffer::resetStats() {
+  pixelsWritten = 0;
+}
+
+bool Framebuffer::save(const char* fileName) {
+  FILE* file = fopen(fileName, "wb");
+  if (file == nullptr) return false;
+  fprintf(file, "P5\n%d %d\n255\n", WIDTH, HEIGHT);
+  fwrite(pixels, 1, sizeof(pixels), file);
+  return fclose(file) == 0;
+}
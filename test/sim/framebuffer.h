@@ -0,0 +1,48 @@
+#pragma once
+#include "vex.h"
+
+// A host framebuffer the size of the brain screen, for drawing the dashboard without a brain. Text is
+// drawn as one solid cell per character at the font's size, which writes as many pixels as a glyph
+// would without carrying a font, so the cost of a frame is close to the brain's.
+class Framebuffer
+{
+private:
+  // The size of the brain screen in pixels.
+  static const int WIDTH = 480;
+  static const int HEIGHT = 240;
+
+  // The gray level of each pixel, row by row.
+  uint8_t pixels[WIDTH * HEIGHT];
+  // The pixels written since the stats were reset.
+  long pixelsWritten = 0;
+
+  // Fills a box clipped to the screen with a gray level.
+  void fill(int x, int y, int width, int height, uint8_t level);
+  // Returns the width and height in pixels of a character cell of a font.
+  static void cellSize(fontType font, int& width, int& height);
+
+  // The canvas functions, with the framebuffer as their target.
+  static void clearTarget(void* target);
+  static void clearBoxTarget(void* target, int x, int y, int width, int height);
+  static void printTextTarget(void* target, int x, int y, fontType font, const char* text);
+
+public:
+  // The constructor for the Framebuffer class. The screen starts black.
+  Framebuffer();
+
+  // Returns a canvas that draws to this framebuffer.
+  DashboardCanvas canvas();
+  // Clears the screen to black.
+  void clear();
+  // Fills a box with black.
+  void clearBox(int x, int y, int width, int height);
+  // Draws white text with its baseline at a point.
+  void printText(int x, int y, fontType font, const char* text);
+
+  // Returns the pixels written since the stats were reset.
+  long getPixelsWritten();
+  // Resets the pixel count.
+  void resetStats();
+  // Writes the screen as a PGM image. Returns false if it could not be written.
+  bool save(const char* fileName);
+};
@@ -0,0 +1,261 @@
+#include "motion-tuner.h"
+#include "workers.h"
+
+namespace {
+// The tuner and plans the workers run.
+MotionTuner* activeTuner = nullptr;
+const TunePlan* activePlans = nullptr;
+}
+
+MotionTuner::MotionTuner(const DriveModel& model) :
+  model(model) {}
+
+MotionTuner::~MotionTuner() {
+  delete[] results;
+}
+
+void MotionTuner::setModel(const DriveModel& model) {
+  this -> model = model;
+}
+
+bool MotionTuner::load(const char* fileName) {
+  FILE* file = fopen(fileName, "r");
+  if (file == nullptr) {
+    printf("%s: cannot be read\n", fileName);
+    return false;
+  }
+  stepCount = 0;
+  voltageCount = 0;
+  exitFactorCount = 0;
+  targetX = 0;
+  targetY = 0;
+  targetHeading = 0;
+  char line[256];
+  int lineNumber = 0;
+  bool valid = true;
+  while (valid && fgets(line, sizeof(line), file)) {
+    lineNumber++;
+    char* comment = strchr(line, '#');
+    if (comment != nullptr) *comment = 0;
+    char word[16];
+    int used = 0;
+    if (sscanf(line, "%15s%n", word, &used) != 1) continue;
+    float values[MAX_TUNE_CANDIDATES];
+    int count = 0;
+    int read = 0;
+    const char* text = line + used;
+    while (count < MAX_TUNE_CANDIDATES && sscanf(text, "%f%n", &values[count], &read) == 1) {
+      text += read;
+      count++;
+    }
+
+    if (strcmp(word, "voltages") == 0 && count > 0) {
+      memcpy(voltages, values, count * sizeof(float));
+      voltageCount = count;
+    } else if (strcmp(word, "exits") == 0 && count > 0) {
+      memcpy(exitFactors, values, count * sizeof(float));
+      exitFactorCount = count;
+    } else if (strcmp(word, "limits") == 0 && count == 2) {
+      maxPositionError = values[0];
+      maxHeadingError = values[1];
+    } else if (strcmp(word, "turn") == 0 && count == 1 && stepCount < MAX_ROUTINE_STEPS) {
+      steps[stepCount++] = {ROUTINE_TURN, values[0], 0, 0, 0};
+      targetHeading = values[0];
+    } else if (strcmp(word, "drive") == 0 && count >= 1 && stepCount < MAX_ROUTINE_STEPS) {
+      // A drive holds the heading the routine has reached unless it names one.
+      RoutineStep step = {ROUTINE_DRIVE, values[0], count > 1 ? values[1] : targetHeading,
+                          count > 2 ? values[2] : 40, count > 3 ? values[3] : 80};
+      steps[stepCount++] = step;
+      targetHeading = step.heading;
+      targetX += step.target * sinf(step.heading * (float)M_PI / 180);
+      targetY += step.target * cosf(step.heading * (float)M_PI / 180);
+    } else {
+      printf("%s:%d: cannot use \"%s\"\n", fileName, lineNumber, word);
+      valid = false;
+    }
+  }
+  fclose(file);
+  if (valid && (stepCount == 0 || voltageCount == 0 || exitFactorCount == 0)) {
+    printf("%s: needs at least one step, voltage and exit factor\n", fileName);
+    valid = false;
+  }
+  return valid;
+}
+
+TuneResult MotionTuner::runTrial(const TunePlan& plan) {
+  TuneResult result;
+  result.plan = plan;
+  result.step = -1;
+
+  // Every trial starts from the same settings and at rest.
+  setChassisDefaults();
+  simulation.reset(model);
+  chassis.setSimulation(&simulation);
+  chassis.setHeading(0);
+  int i = 0;
+  while (i < stepCount && !robotState.drivetrainNeedsStopped) {
+    // The steps chained to this one run as one chain.
+    int last = i;
+    while (last < stepCount - 1 && (plan.chainMask & (1 << last))) last++;
+    if (last > i) {
+      ChainSegment segments[MAX_ROUTINE_STEPS];
+      for (int s = i; s <= last; s++) {
+        const RoutineStep& step = steps[s];
+        segments[s - i] = {step.motion == ROUTINE_TURN ? CHAIN_TURN : CHAIN_DRIVE, step.target, step.heading,
+                           step.maxVelocity, step.acceleration};
+      }
+      chassis.driveChain(segments, last - i + 1);
+    } else if (steps[i].motion == ROUTINE_TURN) {
+      chassis.turnToHeading(steps[i].target, plan.voltages[i], plan.exitFactors[i]);
+    } else {
+      chassis.driveDistance(steps[i].target, plan.voltages[i], steps[i].heading, chassis.getHeadingMaxVoltage(), plan.exitFactors[i]);
+    }
+    i = last + 1;
+  }
+  chassis.setSimulation(nullptr);
+  // A trial that runs past the simulation's limit is stopped, and must not stop the next one.
+  robotState.drivetrainNeedsStopped = false;
+
+  result.time = simulation.getTicks() * 10;
+  float dx = simulation.getTrueX() - targetX;
+  float dy = simulation.getTrueY() - targetY;
+  result.positionError = sqrtf(dx * dx + dy * dy);
+  result.headingError = fabsf(wrap180(simulation.getTrueHeading() - targetHeading));
+  return result;
+}
+
+void MotionTuner::runTask(int index, void* result) {
+  *(TuneResult*)result = activeTuner->runTrial(activePlans[index]);
+}
+
+bool MotionTuner::isBetter(const TuneResult& result) {
+  if (result.positionError > maxPositionError || result.headingError > maxHeadingError) return false;
+  return bestIndex < 0 || result.time < results[bestIndex].time;
+}
+
+int MotionTuner::runStage(const TunePlan* plans, int planCount, int step, int workerCount) {
+  if (resultCount + planCount > resultCapacity) {
+    resultCapacity = (resultCount + planCount) * 2;
+    TuneResult* grown = new TuneResult[resultCapacity];
+    if (resultCount > 0) memcpy(grown, results, resultCount * sizeof(TuneResult));
+    delete[] results;
+    results = grown;
+  }
+  activeTuner = this;
+  activePlans = plans;
+  bool* done = new bool[planCount];
+  int first = resultCount;
+  runOnWorkers(planCount, workerCount, sizeof(TuneResult), runTask, results + first, done);
+  // Keep only the trials that completed.
+  for (int i = 0; i < planCount; i++) {
+    if (!done[i]) continue;
+    results[resultCount] = results[first + i];
+    results[resultCount].step = step;
+    if (isBetter(results[resultCount])) bestIndex = resultCount;
+    resultCount++;
+  }
+  delete[] done;
+  return bestIndex;
+}
+
+int MotionTuner::search(int workerCount) {
+  resultCount = 0;
+  bestIndex = -1;
+
+  // The chaining points, with the steps at the highest voltage and stopping at the end of each.
+  float topVoltage = voltages[0];
+  for (int v = 1; v < voltageCount; v++) topVoltage = fmaxf(topVoltage, voltages[v]);
+  int maskCount = 1 << (stepCount - 1);
+  TunePlan* plans = new TunePlan[maskCount > voltageCount * exitFactorCount ? maskCount : voltageCount * exitFactorCount];
+  for (int mask = 0; mask < maskCount; mask++) {
+    plans[mask].chainMask = mask;
+    for (int s = 0; s < stepCount; s++) {
+      plans[mask].voltages[s] = topVoltage;
+      plans[mask].exitFactors[s] = 1;
+    }
+  }
+  runStage(plans, maskCount, -1, workerCount);
+
+  // The voltage and exit factor of each step left unchained, one step at a time from the best plan so far.
+  for (int s = 0; s < stepCount; s++) {
+    TunePlan best = results[bestIndex >= 0 ? bestIndex : 0].plan;
+    bool chainedIn = s > 0 && (best.chainMask & (1 << (s - 1)));
+    bool chainedOut = best.chainMask & (1 << s);
+    if (chainedIn || chainedOut) continue;
+    int planCount = 0;
+    for (int v = 0; v < voltageCount; v++) {
+      for (int e = 0; e < exitFactorCount; e++) {
+        plans[planCount] = best;
+        plans[planCount].voltages[s] = voltages[v];
+        plans[planCount].exitFactors[s] = exitFactors[e];
+        planCount++;
+      }
+    }
+    runStage(plans, planCount, s, workerCount);
+  }
+  delete[] plans;
+  return bestIndex;
+}
+
+const TuneResult* MotionTuner::getBest() {
+  return bestIndex < 0 ? nullptr : &results[bestIndex];
+}
+
+int MotionTuner::getResultCount() {
+  return resultCount;
+}
+
+bool MotionTuner::saveReport(const char* fileName) {
+  FILE* file = fopen(fileName, "w");
+  if (file == nullptr) return false;
+  // The chaining points are one character per junction, c for chained, and the voltages and exit
+  // factors are per step, with - for a step that runs in a chain.
+  fprintf(file, "stage,chains,voltages,exits,time,positionError,headingError,best\n");
+  for (int i = 0; i < resultCount; i++) {
+    const TuneResult& result = results[i];
+    char chains[MAX_ROUTINE_STEPS + 1];
+    char stepVoltages[MAX_ROUTINE_STEPS * 8] = "";
+    char stepExits[MAX_ROUTINE_STEPS * 8] = "";
+    for (int s = 0; s < stepCount; s++) {
+      if (s < stepCount - 1) chains[s] = (result.plan.chainMask & (1 << s)) ? 'c' : '-';
+      bool chained = (result.plan.chainMask & (1 << s)) || (s > 0 && (result.plan.chainMask & (1 << (s - 1))));
+      const char* separator = s > 0 ? ";" : "";
+      if (chained) {
+        sprintf(stepVoltages + strlen(stepVoltages), "%s-", separator);
+        sprintf(stepExits + strlen(stepExits), "%s-", separator);
+      } else {
+        sprintf(stepVoltages + strlen(stepVoltages), "%s%g", separator, result.plan.voltages[s]);
+        sprintf(stepExits + strlen(stepExits), "%s%g", separator, result.plan.exitFactors[s]);
+      }
+    }
+    chains[stepCount > 0 ? stepCount - 1 : 0] = 0;
+    char stage[16];
+    if (result.step < 0) sprintf(stage, "chains");
+    else sprintf(stage, "step%d", result.step + 1);
+    fprintf(file, "%s,%s,%s,%s,%.0f,%.2f,%.2f,%d\n", stage, chains, stepVoltages, stepExits, result.time,
+            result.positionError, result.headingError, i == bestIndex ? 1 : 0);
+  }
+  fclose(file);
+  return true;
+}
+
+void MotionTuner::printBest() {
+  const TuneResult* best = getBest();
+  if (best == nullptr) {
+    printf("no plan within the limits in %d trials\n", resultCount);
+    return;
+  }
+  // The first trial runs every step stop and go at the highest voltage.
+  float stopAndGo = results[0].time;
+  printf("best of %d trials: %.0f ms (stop and go %.0f ms), ends %.2f in and %.2f deg off\n", resultCount,
+         best->time, stopAndGo, best->positionError, best->headingError);
+  for (int s = 0; s < stepCount; s++) {
+    const RoutineStep& step = steps[s];
+    bool chained = best->plan.chainMask & (1 << s);
+    bool chainedIn = s > 0 && (best->plan.chainMask & (1 << (s - 1)));
+    printf("  %d %s %g", s + 1, step.motion == ROUTINE_TURN ? "turn" : "drive", step.target);
+    if (chained || chainedIn) printf(" in a chain");
+    else printf(" at %gV, earlyExitFactor %g", best->plan.voltages[s], best->plan.exitFactors[s]);
+    printf("%s\n", chained ? ", chained into the next" : "");
+  }
+}
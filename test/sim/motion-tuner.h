@@ -0,0 +1,121 @@
+#pragma once
+#include "vex.h"
+
+// The motions of a routine step.
+enum routineMotion {
+  ROUTINE_DRIVE,  // drives a distance in inches while holding a heading
+  ROUTINE_TURN    // turns in place to a heading
+};
+
+// A step of the routine the tuner searches.
+struct RoutineStep
+{
+  routineMotion motion;
+  // The distance in inches to drive, or the heading to turn to.
+  float target;
+  // The heading to hold while driving. Unused by turns.
+  float heading;
+  // The peak speed in inch/sec and the acceleration in inch/sec^2 of a drive when it is chained.
+  float maxVelocity;
+  float acceleration;
+};
+
+// The most steps of a routine, and the most candidate voltages or exit factors.
+const int MAX_ROUTINE_STEPS = 10;
+const int MAX_TUNE_CANDIDATES = 16;
+
+// How a routine is run: which steps are chained into the next, and the voltage and earlyExitFactor of
+// each step that is not in a chain.
+struct TunePlan
+{
+  // Bit i chains step i into step i + 1.
+  int chainMask;
+  float voltages[MAX_ROUTINE_STEPS];
+  float exitFactors[MAX_ROUTINE_STEPS];
+};
+
+// The result of one trial of the tuner.
+struct TuneResult
+{
+  TunePlan plan;
+  // The step whose voltage and exit factor the trial varied, or -1 for the chaining search.
+  int step;
+  // The simulated time in msec until the routine returned.
+  float time;
+  // The distance in inches and the angle in deg between where the robot really ended up and where the
+  // routine's steps would put it.
+  float positionError;
+  float headingError;
+};
+
+// A class to tune a routine on a simulated drivetrain. The routine is read from a description file,
+// one step per line:
+//
+//   voltages 6 8 10 12     candidate voltages
+//   exits 1 2 3 5          candidate earlyExitFactors
+//   limits 1 2             the largest end position error in inches and heading error in deg
+//   drive 24 0 40 80       inches, the heading to hold, and the chain speed and acceleration
+//   turn 90                the heading to turn to
+//
+// The search first runs every choice of chaining points between the steps, with the unchained steps at
+// the highest voltage and an earlyExitFactor of 1. Then, for each step left unchained, in order, it runs
+// every voltage and exit factor with the other steps at their best so far. A trial wins if it is the
+// fastest whose end position is within the limits. The trials of each stage run on the workers of
+// runOnWorkers(), one per host core by default.
+class MotionTuner
+{
+private:
+  // The plant the trials run on.
+  DriveModel model;
+  DriveSimulation simulation;
+
+  // The routine and the candidates to search.
+  RoutineStep steps[MAX_ROUTINE_STEPS];
+  int stepCount = 0;
+  float voltages[MAX_TUNE_CANDIDATES];
+  int voltageCount = 0;
+  float exitFactors[MAX_TUNE_CANDIDATES];
+  int exitFactorCount = 0;
+  float maxPositionError = 1;
+  float maxHeadingError = 2;
+  // Where the routine's steps would put the robot, in inches with heading 0 along y, and its heading.
+  float targetX = 0;
+  float targetY = 0;
+  float targetHeading = 0;
+
+  // The results of the last search, and the index of the best one or -1.
+  TuneResult* results = nullptr;
+  int resultCount = 0;
+  int resultCapacity = 0;
+  int bestIndex = -1;
+
+  // Runs one trial on the simulation.
+  TuneResult runTrial(const TunePlan& plan);
+  // Runs a trial of the active tuner on a worker.
+  static void runTask(int index, void* result);
+  // Runs the plans on the workers and records their results. Returns the index of the best result so far.
+  int runStage(const TunePlan* plans, int planCount, int step, int workerCount);
+  // Returns whether a result is within the limits and faster than the best so far.
+  bool isBetter(const TuneResult& result);
+
+public:
+  // The constructor for the MotionTuner class.
+  MotionTuner(const DriveModel& model);
+  ~MotionTuner();
+
+  // Sets the plant the trials run on, e.g. the model measured by sysid.
+  void setModel(const DriveModel& model);
+  // Reads a routine description file. Prints the line at fault and returns false if it cannot be used.
+  bool load(const char* fileName);
+  // Searches the chaining points, voltages and exit factors of the routine on workerCount workers.
+  // Returns the index of the best result, or -1 if none met the limits.
+  int search(int workerCount);
+  // Returns the best result of the last search, or nullptr.
+  const TuneResult* getBest();
+  // Returns the number of results in the last search.
+  int getResultCount();
+  // Writes every result of the last search as CSV. Returns false if it could not be written.
+  bool saveReport(const char* fileName);
+  // Prints the best result.
+  void printBest();
+};
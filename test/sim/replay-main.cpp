@@ -0,0 +1,43 @@
+// Replays a motion log from the robot's SD card through the motion code on the host, with the current
+// settings, and reports where the commands diverge from the ones recorded.
+// Usage: replay <motion.bin>
+#include "vex.h"
+#include <chrono>
+#include <libgen.h>
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    printf("usage: %s <motion.bin>\n", argv[0]);
+    return 2;
+  }
+  // The log's folder stands in for the SD card.
+  char folder[256];
+  char name[256];
+  snprintf(folder, sizeof(folder), "%s", argv[1]);
+  snprintf(name, sizeof(name), "%s", argv[1]);
+  host::setSdRoot(dirname(folder));
+  if (!motionLog.load(basename(name))) {
+    printf("%s: not a motion log of this version\n", argv[1]);
+    return 2;
+  }
+
+  // Runs the logged auton on the constants in setChassisDefaults(); the drivetrain reads its sensors
+  // and the front distance from the log, so nothing waits between ticks.
+  host::useManualClock();
+  setChassisDefaults();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  motionLog.startReplay();
+  runBenchmarkAuton(motionLog.getAutonSelection());
+  motionLog.stopReplay();
+  double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  printf("auton %d: %.2f s of log replayed in %.1f ms\n", motionLog.getAutonSelection(),
+         motionLog.getSampleCount() * 0.01, elapsed);
+  if (motionLog.getFirstDivergence() < 0) {
+    printf("matches the log, largest difference %.2f V\n", motionLog.getMaxDivergence());
+    return 0;
+  }
+  printf("diverges at %.2f s (tick %d), largest difference %.2f V\n", motionLog.getFirstDivergence() * 0.01,
+         motionLog.getFirstDivergence(), motionLog.getMaxDivergence());
+  return 1;
+}
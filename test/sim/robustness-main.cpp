@@ -0,0 +1,29 @@
+// Runs an auton many times on the simulated drivetrain under random perturbations, across the host's cores.
+// Usage: robustness <auton index> [runs] [workers] [results.csv]
+#include "robustness.h"
+#include "workers.h"
+
+// Perturbed runs draw a battery between 80% and 100% of full voltage, up to 5% wheel slip,
+// up to 0.05 deg/sec of gyro drift and up to 0.5 deg of noise on each heading reading.
+RobustnessRunner robustnessRunner({0.8, 1.0, 0.05, 0.05, 0.5}, benchmarkModel, runBenchmarkAuton);
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 5) {
+    printf("usage: %s <auton index> [runs] [workers] [results.csv]\n", argv[0]);
+    return 2;
+  }
+  int selection = atoi(argv[1]);
+  int runCount = argc > 2 ? atoi(argv[2]) : 2000;
+  int workerCount = argc > 3 ? atoi(argv[3]) : hostCoreCount();
+  const char* fileName = argc > 4 ? argv[4] : "robustness.csv";
+
+  // A wait() left in the auton passes no simulated time, so it is caught on the manual clock rather than slept.
+  host::useManualClock();
+  if (!robustnessRunner.canSimulate(selection)) {
+    printf("auton %d cannot be simulated: it must drive through the chassis and wait with chassis.waitTime()\n", selection);
+    return 1;
+  }
+  robustnessRunner.run(selection, runCount, workerCount, fileName);
+  robustnessRunner.printStats();
+  return 0;
+}
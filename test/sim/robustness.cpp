@@ -0,0 +1,114 @@
+#include "robustness.h"
+#include "workers.h"
+
+namespace {
+// Whether the robot code called wait() while an auton ran on the simulation.
+bool waitedOutsideChassis = false;
+// The runner and auton the workers run.
+RobustnessRunner* activeRunner = nullptr;
+int activeSelection = 0;
+
+void noteWait() {
+  waitedOutsideChassis = true;
+}
+}
+
+RobustnessRunner::RobustnessRunner(const PerturbationRanges& ranges, const DriveModel& model, void (*runAuton)(int selection)) :
+  ranges(ranges),
+  model(model),
+  runAuton(runAuton),
+  runTimes(100),
+  headingErrors(0.25),
+  poseErrors(0.25) {}
+
+void RobustnessRunner::setModel(const DriveModel& model) {
+  this -> model = model;
+}
+
+float RobustnessRunner::randomBetween(float min, float max) {
+  return min + (max - min) * rand() / (float)RAND_MAX;
+}
+
+Perturbation RobustnessRunner::draw() {
+  Perturbation perturbation;
+  perturbation.voltageScale = randomBetween(ranges.minVoltageScale, ranges.maxVoltageScale);
+  perturbation.encoderScale = 1 + randomBetween(0, ranges.maxEncoderSlip);
+  perturbation.headingDrift = randomBetween(-ranges.maxHeadingDrift, ranges.maxHeadingDrift);
+  perturbation.headingNoise = randomBetween(0, ranges.maxHeadingNoise);
+  return perturbation;
+}
+
+RobustnessRun RobustnessRunner::runOne(int selection, int run) {
+  // The gyro noise draws from the same seed, so a run gives the same result on any worker.
+  srand(run + 1);
+  RobustnessRun result;
+  result.perturbation = draw();
+  // Every run starts from the same settings and at rest.
+  setChassisDefaults();
+  simulation.reset(model);
+  simulation.setPerturbation(result.perturbation);
+  chassis.setSimulation(&simulation);
+  chassis.setHeading(0);
+  runAuton(selection);
+  chassis.setSimulation(nullptr);
+  robotState.drivetrainNeedsStopped = false;
+
+  result.time = simulation.getTicks() * 10;
+  result.headingError = fabsf(wrap180(robotState.desiredHeading - simulation.getTrueHeading()));
+  result.poseError = simulation.getPoseError();
+  return result;
+}
+
+bool RobustnessRunner::canSimulate(int selection) {
+  waitedOutsideChassis = false;
+  host::onWait(noteWait);
+  RobustnessRun result = runOne(selection, 0);
+  host::onWait(nullptr);
+  return !waitedOutsideChassis && result.time > 0;
+}
+
+void RobustnessRunner::runTask(int run, void* result) {
+  *(RobustnessRun*)result = activeRunner->runOne(activeSelection, run);
+}
+
+int RobustnessRunner::run(int selection, int runCount, int workerCount, const char* fileName) {
+  runTimes.reset();
+  headingErrors.reset();
+  poseErrors.reset();
+  if (runCount <= 0) return 0;
+
+  activeRunner = this;
+  activeSelection = selection;
+  RobustnessRun* results = new RobustnessRun[runCount];
+  bool* done = new bool[runCount];
+  runOnWorkers(runCount, workerCount, sizeof(RobustnessRun), runTask, results, done);
+
+  FILE* file = fopen(fileName, "w");
+  if (file != nullptr) fprintf(file, "run,auton,time,headingError,poseError,voltageScale,encoderScale,headingDrift,headingNoise\n");
+  for (int i = 0; i < runCount; i++) {
+    if (!done[i]) continue;
+    const RobustnessRun& result = results[i];
+    runTimes.record(result.time);
+    headingErrors.record(result.headingError);
+    poseErrors.record(result.poseError);
+    if (file == nullptr) continue;
+    fprintf(file, "%d,%d,%.0f,%.2f,%.2f,%.2f,%.3f,%.3f,%.2f\n", i, selection, result.time, result.headingError, result.poseError,
+            result.perturbation.voltageScale, result.perturbation.encoderScale, result.perturbation.headingDrift,
+            result.perturbation.headingNoise);
+  }
+  if (file != nullptr) fclose(file);
+  delete[] results;
+  delete[] done;
+  return getRunCount();
+}
+
+int RobustnessRunner::getRunCount() {
+  return runTimes.getCount();
+}
+
+void RobustnessRunner::printStats() {
+  printf("%d runs, median / 90th percentile:\n", getRunCount());
+  printf("  time %.2f / %.2f s\n", runTimes.percentile(50) / 1000, runTimes.percentile(90) / 1000);
+  printf("  heading error %.2f / %.2f deg\n", headingErrors.percentile(50), headingErrors.percentile(90));
+  printf("  pose error %.2f / %.2f in\n", poseErrors.percentile(50), poseErrors.percentile(90));
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "vex.h"
+
+// The ranges the robustness runs draw their perturbations from.
+struct PerturbationRanges
+{
+  // The share of the commanded voltage that reaches the motors, drawn between these. It stands for
+  // both a low battery and the current limit of a hot motor.
+  float minVoltageScale;
+  float maxVoltageScale;
+  // The largest wheel slip as a share of the distance, e.g. 0.05 for 5%.
+  float maxEncoderSlip;
+  // The largest gyro drift in deg/sec, drawn in either direction.
+  float maxHeadingDrift;
+  // The largest random noise in deg added to each heading reading.
+  float maxHeadingNoise;
+};
+
+// The result of one perturbed run.
+struct RobustnessRun
+{
+  // The simulated time in msec until the auton returned.
+  float time;
+  // The final heading error in deg and the distance in inches between where the robot really ended up
+  // and where its sensors put it.
+  float headingError;
+  float poseError;
+  // The conditions the run was drawn.
+  Perturbation perturbation;
+};
+
+// A class to run an auton many times on a simulated drivetrain, each time under a new random
+// perturbation of the plant and its sensors, and collect the spread of the results, so speed settings
+// can be compared by their worst runs and not just their best. The runs are split across the workers
+// of runOnWorkers(), one per host core by default. Each run draws from its own seed, so the results do
+// not depend on the number of workers.
+class RobustnessRunner
+{
+private:
+  // The ranges to draw perturbations from.
+  PerturbationRanges ranges;
+  // The plant the runs are simulated on.
+  DriveModel model;
+  DriveSimulation simulation;
+  // Runs the auton at a menu index.
+  void (*runAuton)(int selection);
+
+  // The run times in msec, final heading errors in deg and final pose errors in inches.
+  LatencyStats runTimes;
+  LatencyStats headingErrors;
+  LatencyStats poseErrors;
+
+  // Returns a random value between min and max.
+  float randomBetween(float min, float max);
+  // Draws a perturbation from the ranges.
+  Perturbation draw();
+  // Runs the auton once under the perturbation drawn for a run number.
+  RobustnessRun runOne(int selection, int run);
+  // Runs a run of the active runner on a worker.
+  static void runTask(int run, void* result);
+
+public:
+  // The constructor for the RobustnessRunner class.
+  RobustnessRunner(const PerturbationRanges& ranges, const DriveModel& model, void (*runAuton)(int selection));
+
+  // Sets the plant the runs are simulated on, e.g. the model measured by sysid.
+  void setModel(const DriveModel& model);
+  // Returns whether an auton runs on the simulation: it must move the drivetrain and wait only through
+  // the chassis, as a wait() outside it passes no simulated time.
+  bool canSimulate(int selection);
+  // Clears the recorded runs, then runs the auton at a menu index runCount times on workerCount workers
+  // and writes every run to a CSV file with the conditions it ran in. The draws are the same on every
+  // call, so two speed settings are compared under the same conditions.
+  // Returns the number of runs completed.
+  int run(int selection, int runCount, int workerCount, const char* fileName);
+
+  // Returns the number of runs recorded.
+  int getRunCount();
+  // Prints the median and 90th percentile run time, heading error and pose error.
+  void printStats();
+};
@@ -0,0 +1,23 @@
+// Searches the chaining points, voltages and exit factors of a routine on the simulated drivetrain,
+// across the host's cores. Usage: tune <routine.txt> [report.csv] [workers]
+#include "motion-tuner.h"
+#include "workers.h"
+
+MotionTuner motionTuner(benchmarkModel);
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 4) {
+    printf("usage: %s <routine.txt> [report.csv] [workers]\n", argv[0]);
+    return 2;
+  }
+  const char* reportFile = argc > 2 ? argv[2] : "tune.csv";
+  int workerCount = argc > 3 ? atoi(argv[3]) : hostCoreCount();
+  if (!motionTuner.load(argv[1])) return 2;
+
+  // The trials run on the constants in setChassisDefaults() and the benchmark's plant.
+  host::useManualClock();
+  motionTuner.search(workerCount);
+  if (!motionTuner.saveReport(reportFile)) printf("%s: cannot be written\n", reportFile);
+  motionTuner.printBest();
+  return motionTuner.getBest() != nullptr ? 0 : 1;
+}
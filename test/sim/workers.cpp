@@ -0,0 +1,72 @@
+#include "workers.h"
+#include <stdio.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+// The most workers of one call.
+const int MAX_WORKERS = 256;
+
+// Reads a whole result from a pipe. Returns false at the end of the pipe.
+bool readResult(int input, char* result, size_t resultSize) {
+  size_t received = 0;
+  while (received < resultSize) {
+    ssize_t length = read(input, result + received, resultSize - received);
+    if (length <= 0) return false;
+    received += length;
+  }
+  return true;
+}
+}
+
+int runOnWorkers(int taskCount, int workerCount, size_t resultSize, void (*task)(int index, void* result),
+                 void* results, bool* done) {
+  for (int i = 0; i < taskCount; i++) done[i] = false;
+  if (taskCount <= 0) return 0;
+  if (workerCount > taskCount) workerCount = taskCount;
+  if (workerCount > MAX_WORKERS) workerCount = MAX_WORKERS;
+  if (workerCount < 1) workerCount = 1;
+
+  // Each worker sends its results back through a pipe, in the order of its tasks.
+  int inputs[MAX_WORKERS];
+  pid_t workers[MAX_WORKERS];
+  fflush(stdout);
+  for (int w = 0; w < workerCount; w++) {
+    int ends[2];
+    if (pipe(ends) != 0) {
+      workerCount = w;
+      break;
+    }
+    workers[w] = fork();
+    if (workers[w] == 0) {
+      close(ends[0]);
+      char* result = new char[resultSize];
+      for (int i = w; i < taskCount; i += workerCount) {
+        task(i, result);
+        if (write(ends[1], result, resultSize) != (ssize_t)resultSize) break;
+      }
+      close(ends[1]);
+      _exit(0);
+    }
+    close(ends[1]);
+    inputs[w] = ends[0];
+  }
+
+  int completed = 0;
+  for (int w = 0; w < workerCount; w++) {
+    for (int i = w; i < taskCount; i += workerCount) {
+      if (!readResult(inputs[w], (char*)results + i * resultSize, resultSize)) break;
+      done[i] = true;
+      completed++;
+    }
+    close(inputs[w]);
+    waitpid(workers[w], nullptr, 0);
+  }
+  return completed;
+}
+
+int hostCoreCount() {
+  int count = std::thread::hardware_concurrency();
+  return count > 0 ? count : 1;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <stddef.h>
+
+// Runs tasks 0 to taskCount - 1 on workerCount forked copies of the program and collects the result of
+// each, resultSize bytes, into results in task order. The robot code keeps the chassis and the robot
+// state in globals, so the workers are processes rather than threads; each starts from the state the
+// program had at the call. Task i runs on worker i % workerCount. done[i] is set for each task whose
+// result arrived. Returns the number of tasks completed.
+int runOnWorkers(int taskCount, int workerCount, size_t resultSize, void (*task)(int index, void* result),
+                 void* results, bool* done);
+
+// Returns the number of cores of the host, the default worker count.
+int hostCoreCount();
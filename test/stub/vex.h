@@ -0,0 +1,9 @@
+#pragma once
+// A host stand-in for the VEX SDK header, so the pure control code builds on Linux or macOS.
+// It only provides what PID.cpp and control-math.h need; nothing that talks to a device builds against it.
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "rgb-template/control-math.h"
+#include "rgb-template/PID.h"